@@ -0,0 +1,176 @@
+/**
+ * Fetches the weather on a long interval and sends it to the watch as a
+ * two byte payload (see WeatherPayload in src/main.c, keep the two in sync):
+ *
+ *   [0] temperature in degrees celsius, two's complement
+ *   [1] condition code (see CONDITIONS)
+ */
+
+//--------------------------CONSTANTS--------------------------
+
+/**
+ * True to use the local mock provider instead of the network
+ */
+var USE_MOCK_PROVIDER = false;
+
+/**
+ * How often the weather is refreshed while the watchface runs
+ */
+var REFRESH_INTERVAL_MS = 30 * 60 * 1000;
+
+/**
+ * The least time between two fetches, even across restarts of the watchface
+ */
+var MIN_FETCH_INTERVAL_MS = 15 * 60 * 1000;
+
+/**
+ * The condition codes shown on the watch
+ */
+var CONDITIONS = {
+    UNKNOWN: 0,
+    CLEAR: 1,
+    CLOUDS: 2,
+    RAIN: 3,
+    SNOW: 4,
+    STORM: 5,
+    FOG: 6
+};
+
+
+
+//--------------------------PROVIDERS--------------------------
+
+/**
+ * Gets the weather at the current location from open-meteo (no api key needed)
+ *
+ * @param callback called with {temperature, condition}, or null on failure
+ */
+function openMeteoProvider(callback) {
+    navigator.geolocation.getCurrentPosition(function(position) {
+        var request = new XMLHttpRequest();
+        request.onload = function() {
+            try {
+                var current = JSON.parse(this.responseText).current_weather;
+                callback({
+                    temperature: Math.round(current.temperature),
+                    condition: conditionFromWmoCode(current.weathercode)
+                });
+            } catch (error) {
+                callback(null);
+            }
+        };
+        request.onerror = function() {
+            callback(null);
+        };
+        request.open('GET', 'https://api.open-meteo.com/v1/forecast?current_weather=true'
+            + '&latitude=' + position.coords.latitude
+            + '&longitude=' + position.coords.longitude);
+        request.send();
+    }, function() {
+        callback(null);
+    }, { timeout: 15000, maximumAge: 60 * 60 * 1000 });
+}
+
+/**
+ * Gets made up weather without touching the network, stepping through
+ * every condition and a range of temperatures below and above zero
+ *
+ * @param callback called with {temperature, condition}
+ */
+function mockProvider(callback) {
+    var step = parseInt(localStorage.getItem('mockWeatherStep') || '0', 10);
+    localStorage.setItem('mockWeatherStep', String(step + 1));
+    callback({
+        temperature: (step * 7) % 61 - 20,
+        condition: step % 7
+    });
+}
+
+/**
+ * Maps a WMO weather code to a condition code
+ *
+ * @param code the WMO weather code
+ *
+ * @return the condition code
+ */
+function conditionFromWmoCode(code) {
+    if (code === 0) return CONDITIONS.CLEAR;
+    if (code <= 3) return CONDITIONS.CLOUDS;
+    if (code === 45 || code === 48) return CONDITIONS.FOG;
+    if ((code >= 51 && code <= 67) || (code >= 80 && code <= 82)) return CONDITIONS.RAIN;
+    if ((code >= 71 && code <= 77) || code === 85 || code === 86) return CONDITIONS.SNOW;
+    if (code >= 95) return CONDITIONS.STORM;
+    return CONDITIONS.UNKNOWN;
+}
+
+
+
+//--------------------------REFRESH--------------------------
+
+/**
+ * Packs the given weather into the bytes sent to the watch
+ *
+ * @param weather the weather to pack
+ *
+ * @return the payload bytes
+ */
+function packWeather(weather) {
+    var temperature = Math.max(-128, Math.min(127, weather.temperature));
+    return [temperature & 0xFF, weather.condition & 0xFF];
+}
+
+/**
+ * Fetches the weather, unless fetched recently, and sends it to the watch
+ * if it changed since it was last sent
+ */
+function refreshWeather() {
+    // Return if fetched recently
+    var now = Date.now();
+    var lastFetch = parseInt(localStorage.getItem('weatherLastFetch') || '0', 10);
+    if (now - lastFetch < MIN_FETCH_INTERVAL_MS) {
+        return;
+    }
+    localStorage.setItem('weatherLastFetch', String(now));
+    
+    // Fetch and send
+    var provider = USE_MOCK_PROVIDER ? mockProvider : openMeteoProvider;
+    provider(function(weather) {
+        if (!weather) {
+            return;
+        }
+        
+        // Skip if unchanged, the watch got the last payload on ready
+        var payload = packWeather(weather);
+        if (localStorage.getItem('weatherLastSent') === JSON.stringify(payload)) {
+            return;
+        }
+        sendWeather(payload);
+    });
+}
+
+/**
+ * Sends the given payload to the watch, remembering it once acknowledged
+ *
+ * @param payload the payload bytes
+ */
+function sendWeather(payload) {
+    Pebble.sendAppMessage({ WEATHER: payload }, function() {
+        localStorage.setItem('weatherLastSent', JSON.stringify(payload));
+    }, function() {
+        console.log('Sending weather failed');
+    });
+}
+
+
+
+//--------------------------EVENTS--------------------------
+
+Pebble.addEventListener('ready', function() {
+    // Resend the last payload, the watch may have lost its saved weather
+    var lastSent = localStorage.getItem('weatherLastSent');
+    if (lastSent) {
+        sendWeather(JSON.parse(lastSent));
+    }
+    refreshWeather();
+    setInterval(refreshWeather, REFRESH_INTERVAL_MS);
+});
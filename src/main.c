@@ -22,479 +22,4156 @@
  */
 #define DAY_BINARY_LENGTH 6
 
+/**
+ * The number of bit cells of all fields
+ */
+#define CELL_COUNT (HOUR_BINARY_LENGTH + MINUTE_BINARY_LENGTH + MONTH_BINARY_LENGTH + DAY_BINARY_LENGTH)
+
+
+/**
+ * The number of minutes in an hour
+ */
+#define MINUTES_PER_HOUR 60
+
+/**
+ * The number of hours in a day
+ */
+#define HOURS_PER_DAY 24
+
+/**
+ * The number of days in a week
+ */
+#define DAYS_PER_WEEK 7
+
+/**
+ * The number of months in a year
+ */
+#define MONTHS_PER_YEAR 12
+
+/**
+ * The number of days in a year that is not a leap year
+ */
+#define DAYS_PER_YEAR 365
+
+/**
+ * The number of minutes in a day
+ */
+#define MINUTES_PER_DAY (HOURS_PER_DAY * MINUTES_PER_HOUR)
+
+/**
+ * The number of minutes in a week
+ */
+#define MINUTES_PER_WEEK (DAYS_PER_WEEK * MINUTES_PER_DAY)
+
 
 /**
- * The left margin of the TextLayers if the watch is square
+ * The left margin of the field layers if the watch is square
  */
 #define LEFT_MARGIN_SQUARE 10
 
 /**
- * The left margin of the TextLayers if the watch is round
+ * The left margin of the field layers if the watch is round
  */
 #define LEFT_MARGIN_ROUND 25
 
 
 /**
- * The top margin of the time TextLayers if the watch is square
+ * The top margin of the time field layers if the watch is square
  */
 #define TIME_TOP_MARGIN_SQUARE 10
 
 /**
- * The top margin of the date TextLayers if the watch is round
+ * The top margin of the date field layers if the watch is round
  */
 #define TIME_TOP_MARGIN_ROUND 24
 
 /**
- * The height of the time TextLayers
+ * The spacing between the rows of the time
  */
 #define TIME_HEIGHT 32
 
 
 /**
- * The top margin of the date TextLayers if the watch is square
+ * The top margin of the date field layers if the watch is square
  */
 #define DATE_TOP_MARGIN_SQUARE 100
 
 /**
- * The top margin of the date TextLayers if the watch is round
+ * The top margin of the date field layers if the watch is round
  */
 #define DATE_TOP_MARGIN_ROUND 100
 
 /**
- * The height of the date TextLayers
+ * The spacing between the rows of the date
  */
 #define DATE_HEIGHT 24
 
 
-//--------------------------PROGRAM RESOURCES--------------------------
+/**
+ * True if the fractions of the day, week and year elapsed
+ * are shown as rows of cells between the time and the date
+ */
+#define PROGRESS_ROWS_ENABLED true
 
 /**
- * The font of the time
+ * The number of bits shown of each progress fraction
  */
-static GFont time_font;
+#define PROGRESS_BINARY_LENGTH 8
 
 /**
- * The font of the date
+ * The top margin of the progress rows if the watch is square
  */
-static GFont date_font;
+#define PROGRESS_TOP_MARGIN_SQUARE 82
 
+/**
+ * The top margin of the progress rows if the watch is round
+ */
+#define PROGRESS_TOP_MARGIN_ROUND 88
 
+/**
+ * The spacing between the cells of a row of bit cells (progress, weather)
+ */
+#define BIT_ROW_CELL_WIDTH 10
 
-//--------------------------PROGRAM OBJECTS--------------------------
+/**
+ * The height of the cells of a row of bit cells
+ */
+#define BIT_ROW_CELL_HEIGHT 3
 
 /**
- * The main window of the program
+ * The spacing between rows of bit cells
  */
-static Window* main_window;
+#define BIT_ROW_HEIGHT 4
+
 
 /**
- * Called when the given window is loaded
- *
- * @param window the window that was loaded
+ * True if the temperature and condition sent from the phone
+ * are shown as rows of cells below the date
  */
-static void on_main_window_load(Window* window);
+#define WEATHER_ENABLED true
 
 /**
- * Called when the given window is unloaded
- *
- * @param window the window that was unloaded
+ * The number of bits shown of the temperature (two's complement degrees celsius)
  */
-static void on_main_window_unload(Window* window);
+#define WEATHER_TEMPERATURE_BINARY_LENGTH 8
 
+/**
+ * The number of bits shown of the condition code
+ */
+#define WEATHER_CONDITION_BINARY_LENGTH 4
 
 /**
- * Displays the hours of the time
+ * The top margin of the weather rows if the watch is square
  */
-static TextLayer* hour_layer;
+#define WEATHER_TOP_MARGIN_SQUARE 152
 
 /**
- * Displays the minutes of the time
+ * The top margin of the weather rows if the watch is round
  */
-static TextLayer* minute_layer;
+#define WEATHER_TOP_MARGIN_ROUND 150
+
 
 /**
- * Displays the month of the date
+ * The largest size text is measured in when caching font metrics
  */
-static TextLayer* month_layer;
+#define FONT_MEASURE_BOX GRect(0, 0, 100, 100)
+
 
 /**
- * Displays the day of the date
+ * The width and height of the round display
  */
-static TextLayer* day_layer;
+#define ROUND_DISPLAY_SIZE 180
 
 
 /**
- * Called on every tick
- *
- * @param tick_time     the current time
- * @param units_changed the amount of time since the last tick
+ * True if flipped bits slide into place when the time changes
  */
-static void on_tick(struct tm* tick_time, TimeUnits units_changed);
+#define BIT_ANIMATION_ENABLED true
 
 /**
- * Displays the time on the watch
- *
- * @param tick_time the time to display on the watch
+ * The total duration of a bit flip animation in milliseconds
  */
-static void display_time(struct tm* tick_time);
+#define BIT_ANIMATION_DURATION_MS 300
 
 /**
- * Logs decimal and binary representations of time to console
- *
- * @param tick_time the time being displayed
+ * The maximum number of redraws during a bit flip animation
  */
-static void debug_time(struct tm* tick_time);
+#define BIT_ANIMATION_MAX_FRAMES 8
 
 /**
- * Returns the hours of the tick_time formatted correctly
- *
- * @param tick_time the tick_time to get the hours from
- *
- * @return the hours formatted correctly
+ * The battery percentage at or below which bit flips are not animated
  */
-static int tm_get_hours(struct tm* tick_time);
+#define BIT_ANIMATION_MIN_BATTERY_PERCENT 20
+
 
 /**
- * Returns the months of the tick_time formatted correctly
- *
- * @param tick_time the tick_time to get the months from
- *
- * @return the months formatted correctly
+ * True if every tick logs the displayed values in decimal and binary
  */
-static int tm_get_months(struct tm* tick_time);
+#define DEBUG_TIME_ENABLED false
+
 
 /**
- * Fills the given buffer with the given value represented in binary
- *
- * @param buffer the buffer to write to
- * @param length the length of the buffer to write to
- * @param value  the value to write as binary
+ * True if every tick checks that the heap has not grown since load
  */
-static void format_as_binary(char* buffer, size_t length, int value);
+#define HEAP_CHECK_ENABLED false
+
 
 /**
- * Raises the given base to the given exponent
- *
- * @param base   the base to raise to the given exponent
- * @param expont the exponent to raise the base to
- *
- * @return the given base raised to the given exponent
+ * True if update latency and tick jitter are measured into hourly histograms
  */
-static int power(int base, int expont);
+#define PROFILER_ENABLED false
 
+/**
+ * The number of buckets in each profiler histogram
+ */
+#define PROFILER_BUCKET_COUNT 11
 
+/**
+ * The number of milliseconds in a minute
+ */
+#define MS_PER_MINUTE 60000
 
-//--------------------------BINARY BUFFERS--------------------------
+/**
+ * True if the profiler also logs begin/end spans of each phase as
+ * Chrome trace events, for viewing in Perfetto or chrome://tracing
+ */
+#define TRACE_EVENTS_ENABLED false
 
 /**
- * Stores the binary representation of the hours
+ * The number of trace events held before logging them
  */
-static char hour_binary_buffer[HOUR_BINARY_LENGTH + 1];
+#define TRACE_EVENT_COUNT 64
+
 
 /**
- * Stores the binary representation of the minutes
- */ 
-static char minute_binary_buffer[MINUTE_BINARY_LENGTH + 1];
+ * True if daily performance counters are checked against the budgets below
+ * and the baselines stored from the first full day, a developer option that
+ * only logs warnings (the latency baseline also needs PROFILER_ENABLED)
+ */
+#define PERF_BUDGET_ENABLED false
 
 /**
- * Stores the binary representation of the month
+ * How far in percent a daily counter may exceed its budget before warning
  */
-static char month_binary_buffer[MONTH_BINARY_LENGTH + 1];
+#define PERF_REGRESSION_THRESHOLD_PERCENT 10
 
 /**
- * Stores the binary representation of the day
+ * The budget of window renders per day: each minute renders once for
+ * the new time, up to BIT_ANIMATION_MAX_FRAMES times while animating,
+ * and once more when the animation stops (a render runs every visible
+ * update proc, but is counted once)
  */
-static char day_binary_buffer[DAY_BINARY_LENGTH + 1];
+#define PERF_BUDGET_DRAWS_PER_DAY (MINUTES_PER_DAY * (2 + BIT_ANIMATION_MAX_FRAMES))
 
+/**
+ * The budget of bit cells flipped per day: a counter flips just under
+ * 2 bits per step on average, so 2 per minute and per hour, plus the date
+ */
+#define PERF_BUDGET_BIT_FLIPS_PER_DAY (2 * MINUTES_PER_DAY + 2 * HOURS_PER_DAY + MONTH_BINARY_LENGTH + DAY_BINARY_LENGTH)
+
+/**
+ * The persist key of the performance baseline
+ */
+#define PERSIST_KEY_PERF_BASELINE 3
 
-//--------------------------DEBUG BUFFERS--------------------------
 
 /**
- * String representation of hour value for debug purposes
+ * True if hourly performance records are sent through data logging,
+ * for developers running tools/telemetry_receiver.py
  */
-static char hour_debug_buffer[32];
+#define TELEMETRY_ENABLED false
 
 /**
- * String representation of minute value for debug purposes
+ * The data logging tag of telemetry records
  */
-static char minute_debug_buffer[32];
+#define TELEMETRY_TAG 0x42540001
 
 /**
- * String representation of month value for debug purposes
+ * The number of seconds in an hour
  */
-static char month_debug_buffer[32];
+#define SECONDS_PER_HOUR 3600
 
 /**
- * String representation of day value for debug purposes
+ * The number of seconds in a minute
  */
-static char day_debug_buffer[32];
+#define SECONDS_PER_MINUTE 60
 
 
+/**
+ * True if the face only ticks hourly while the wearer is asleep
+ * (on platforms with health tracking)
+ */
+#define SLEEP_SUPPRESSION_ENABLED true
 
-//--------------------------BINARY TIME FUNCTIONS--------------------------
 
 /**
- * Displays the time and date on the watch
- *
- * @param tick_time the time to display on the watch
+ * True if a countdown target sent from the phone replaces
+ * the time with the hours and minutes left until it
  */
-static void display_time(struct tm* tick_time) {
-    // Fill binary buffers with binaries of the time and date values
-    format_as_binary(hour_binary_buffer, sizeof(hour_binary_buffer), tm_get_hours(tick_time));
-    format_as_binary(minute_binary_buffer, sizeof(minute_binary_buffer), tick_time->tm_min);
-    format_as_binary(month_binary_buffer, sizeof(month_binary_buffer), tm_get_months(tick_time));
-    format_as_binary(day_binary_buffer, sizeof(day_binary_buffer), tick_time->tm_mday);
-    
-    // Log time, along with new binary values, to console
-    debug_time(tick_time);
-    
-    // Set text layers with time and date buffers
-    text_layer_set_text(hour_layer, hour_binary_buffer);
-    text_layer_set_text(minute_layer, minute_binary_buffer);
-    text_layer_set_text(month_layer, month_binary_buffer);
-    text_layer_set_text(day_layer, day_binary_buffer);
-}
+#define COUNTDOWN_ENABLED true
 
 /**
- * Returns the hours of the tick_time formatted correctly
- *
- * @param tick_time the tick_time to get the hours from
- *
- * @return the hours formatted correctly
+ * The app message key of the countdown target (seconds since the epoch, 0 to cancel)
  */
-static int tm_get_hours(struct tm* tick_time) {
-    // Get hours from tick_time
-    int hours = tick_time->tm_hour;
-    
-    // If clock is 24 hour style, return hours
-    // Else if hour mod 12 is 0, return 12 
-    // (as 0 is represented by 12 in 12 hour clock)
-    // Else return hours mod 12
-    return clock_is_24h_style() ? hours 
-                                : (hours % 12 == 0 ? 12 
-                                                   : hours % 12);
-}
+#define APP_KEY_COUNTDOWN_TARGET 0
 
 /**
- * Returns the months of the tick_time formatted correctly
- *
- * @param tick_time the tick_time to get the months from
- *
- * @return the months formatted correctly
+ * The app message key of the weather (a packed WeatherPayload)
  */
-static int tm_get_months(struct tm* tick_time) {
-    return tick_time->tm_mon + 1;
-}
+#define APP_KEY_WEATHER 1
 
 /**
- * Raises the given base to the given exponent
- *
- * @param base   the base to raise to the given exponent
- * @param expont the exponent to raise the base to
- *
- * @return the given base raised to the given exponent
+ * The persist key of the countdown target
  */
-static int power(int base, int expont) {
-    // Initialize power value
-    int p = 1;
-    
-    // Multiply by base exponent number of times
-    for (int i = 0; i < expont; i++) {
-        p *= base;
-    }
-    
-    // Return final value
-    return p;
-}
+#define PERSIST_KEY_COUNTDOWN_TARGET 0
 
 /**
- * Fills the given buffer with the given value represented in binary
- *
- * @param buffer the buffer to write to
- * @param length the length of the buffer to write to
- * @param value  the value to write as binary
+ * The persist key of the countdown wakeup
  */
-static void format_as_binary(char* buffer, size_t length, int value) {
-    // Initialize store and end integer values
-    int store = value, end = (int)length - 1;
-    
-    // For each location from start to end of string
-    for (int i = 0; i < end; i++) {
-        // If the store is greater than the binary value 
-        // represented by the digit at the location
-        if (store >= power(2, end - 1 - i)) {
-            // Write a 1 to the buffer at the location
-            // And subtract value from store
-            buffer[i] = '1';
-            store -= power(2, end - 1 - i);
-        } else {
-            // Write a 0 to the buffer at the location
-            buffer[i] = '0';
-        }
-    }
-    
-    // Append null terminator character
-    buffer[end] = '\0';
-}
+#define PERSIST_KEY_COUNTDOWN_WAKEUP 1
 
+/**
+ * The persist key of the last weather received
+ */
+#define PERSIST_KEY_WEATHER 2
 
+/**
+ * The cookie the countdown wakeup is scheduled with
+ */
+#define COUNTDOWN_WAKEUP_COOKIE 0
 
-//--------------------------DEBUG FUNCTION--------------------------
+/**
+ * The number of minutes past the target tried if its wakeup slot is taken
+ */
+#define COUNTDOWN_WAKEUP_RETRIES 3
 
 /**
- * Logs decimal and binary representations of time to console
- *
- * @param tick_time the time being displayed
+ * The largest number of hours the hour field can show
  */
-static void debug_time(struct tm* tick_time) {
-    // Prints hour and minute values to buffers
-    snprintf(hour_debug_buffer, sizeof(hour_debug_buffer), "Hours %i --> %s", tm_get_hours(tick_time), hour_binary_buffer);
-    snprintf(minute_debug_buffer, sizeof(minute_debug_buffer), "Minutes %i --> %s", tick_time->tm_min, minute_binary_buffer);
-    snprintf(month_debug_buffer, sizeof(month_debug_buffer), "Month %i --> %s", tm_get_months(tick_time), month_binary_buffer);
-    snprintf(day_debug_buffer, sizeof(day_debug_buffer), "Day %i --> %s", tick_time->tm_mday, day_binary_buffer);
-    
-    // Log values to console
-    APP_LOG(APP_LOG_LEVEL_INFO, "%s", hour_debug_buffer);
-    APP_LOG(APP_LOG_LEVEL_INFO, "%s", minute_debug_buffer);
-    APP_LOG(APP_LOG_LEVEL_INFO, "%s", month_debug_buffer);
-    APP_LOG(APP_LOG_LEVEL_INFO, "%s", day_debug_buffer);
-}
+#define COUNTDOWN_MAX_HOURS ((1 << HOUR_BINARY_LENGTH) - 1)
 
+/**
+ * The size of the app message inbox in bytes
+ */
+#define APP_MESSAGE_INBOX_SIZE 64
 
+/**
+ * The size of the app message outbox in bytes
+ */
+#define APP_MESSAGE_OUTBOX_SIZE 0
 
-//--------------------------TICK TIMER HANDLER--------------------------
 
 /**
- * Called on every tick
- *
- * @param tick_time     the current time
- * @param units_changed the amount of time since the last tick
+ * True if every input is recorded to a binary trace dumped to the log
+ * (meant for debug builds, for replaying sessions offline)
  */
-static void on_tick(struct tm* tick_time, TimeUnits units_changed) {
-    display_time(tick_time);
-}
-
+#define TRACE_CAPTURE_ENABLED false
 
+/**
+ * The version written at the start of every trace
+ */
+#define TRACE_VERSION 3
 
-//--------------------------WINDOW HANDLERS--------------------------
+/**
+ * The number of bytes of trace held before dumping to the log
+ */
+#define TRACE_BUFFER_SIZE 120
 
 /**
- * Called when the given window is loaded
- *
- * @param window the window that was loaded
+ * The most bytes of a message value recorded in the trace
  */
-static void on_main_window_load(Window* window) {
-    // Load resources
-    time_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_KEY_PERFECT_DOS_32));
-    date_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_KEY_PERFECT_DOS_24));
-    
-    // Get window information
-    Layer *window_layer = window_get_root_layer(window);
-    GRect window_bounds = layer_get_bounds(window_layer);
-    
-    // Create time and date layers
-    hour_layer = text_layer_create(GRect(PBL_IF_ROUND_ELSE(LEFT_MARGIN_ROUND, LEFT_MARGIN_SQUARE),
-                                         PBL_IF_ROUND_ELSE(TIME_TOP_MARGIN_ROUND, TIME_TOP_MARGIN_SQUARE),
-                                         window_bounds.size.w - PBL_IF_ROUND_ELSE(LEFT_MARGIN_ROUND, LEFT_MARGIN_SQUARE),
-                                         TIME_HEIGHT));
-    minute_layer = text_layer_create(GRect(PBL_IF_ROUND_ELSE(LEFT_MARGIN_ROUND, LEFT_MARGIN_SQUARE),
-                                           PBL_IF_ROUND_ELSE(TIME_TOP_MARGIN_ROUND, TIME_TOP_MARGIN_SQUARE) + TIME_HEIGHT,
-                                           window_bounds.size.w - PBL_IF_ROUND_ELSE(LEFT_MARGIN_ROUND, LEFT_MARGIN_SQUARE),
-                                           TIME_HEIGHT));
-    month_layer = text_layer_create(GRect(PBL_IF_ROUND_ELSE(LEFT_MARGIN_ROUND, LEFT_MARGIN_SQUARE),
-                                          PBL_IF_ROUND_ELSE(DATE_TOP_MARGIN_ROUND, DATE_TOP_MARGIN_SQUARE),
-                                          window_bounds.size.w - PBL_IF_ROUND_ELSE(LEFT_MARGIN_ROUND, LEFT_MARGIN_SQUARE),
-                                          DATE_HEIGHT));
-    day_layer = text_layer_create(GRect(PBL_IF_ROUND_ELSE(LEFT_MARGIN_ROUND, LEFT_MARGIN_SQUARE),
-                                        PBL_IF_ROUND_ELSE(DATE_TOP_MARGIN_ROUND, DATE_TOP_MARGIN_SQUARE) + DATE_HEIGHT,
-                                        window_bounds.size.w - PBL_IF_ROUND_ELSE(LEFT_MARGIN_ROUND, LEFT_MARGIN_SQUARE),
-                                        DATE_HEIGHT));
-    
-    // Set style of hour layer
-    text_layer_set_background_color(hour_layer, GColorClear);
-    text_layer_set_text_color(hour_layer, GColorGreen);
-    text_layer_set_text_alignment(hour_layer, GTextAlignmentLeft);
-    text_layer_set_font(hour_layer, time_font);
-    
-    // Set style of minute layer
-    text_layer_set_background_color(minute_layer, GColorClear);
-    text_layer_set_text_color(minute_layer, GColorGreen);
-    text_layer_set_text_alignment(minute_layer, GTextAlignmentLeft);
-    text_layer_set_font(minute_layer, time_font);
-    
-    // Set style of month layer
-    text_layer_set_background_color(month_layer, GColorClear);
-    text_layer_set_text_color(month_layer, GColorGreen);
-    text_layer_set_text_alignment(month_layer, GTextAlignmentLeft);
-    text_layer_set_font(month_layer, date_font);
-    
-    // Set style of day layer
-    text_layer_set_background_color(day_layer, GColorClear);
-    text_layer_set_text_color(day_layer, GColorGreen);
-    text_layer_set_text_alignment(day_layer, GTextAlignmentLeft);
-    text_layer_set_font(day_layer, date_font);
-    
-    // Append text layers to window
-    layer_add_child(window_layer, text_layer_get_layer(hour_layer));
-    layer_add_child(window_layer, text_layer_get_layer(minute_layer));
-    layer_add_child(window_layer, text_layer_get_layer(month_layer));
-    layer_add_child(window_layer, text_layer_get_layer(day_layer));
-    
-    // Display time on init
-    time_t init_time = time(NULL);
-    struct tm* init_tick_time = localtime(&init_time);
-    display_time(init_tick_time);
-}
+#define TRACE_MESSAGE_MAX_BYTES 8
 
 /**
- * Called when the given window is unloaded
- *
- * @param window the window that was unloaded
+ * The number of bytes of trace dumped per log line
  */
-static void on_main_window_unload(Window* window) {
-    // Destroy layers
-    text_layer_destroy(hour_layer);
-    text_layer_destroy(minute_layer);
-    text_layer_destroy(month_layer);
-    text_layer_destroy(day_layer);
-}
+#define TRACE_LOG_LINE_BYTES 40
 
 
+/**
+ * How long the decimal overlay stays visible after a flick in milliseconds
+ */
+#define DECIMAL_OVERLAY_DURATION_MS 3000
 
-//--------------------------MAIN PROGRAM--------------------------
+/**
+ * How long the decimal overlay stays visible after a flick and hold in milliseconds
+ */
+#define DECIMAL_OVERLAY_HOLD_DURATION_MS 10000
 
 /**
- * Called at the start of the program
+ * The top margin of the decimal overlay
  */
-static void start(void) {
-    // Register with the tick timer service
-    tick_timer_service_subscribe(MINUTE_UNIT, on_tick);
-    
-    // Create main window
-    main_window = window_create();
-    
-    // Set window handlers
-    window_set_window_handlers(main_window, (WindowHandlers) {
-        .load = on_main_window_load,
-        .unload = on_main_window_unload
-    });
-    
-    // Set window color
-    window_set_background_color(main_window, GColorBlack);
-    
-    // Display main window
-    window_stack_push(main_window, true);
-}
+#define DECIMAL_OVERLAY_TOP_MARGIN 60
 
 /**
- * Called at the end of the program
+ * The height of the decimal overlay (two rows of the date font)
  */
-static void end(void) {
-    // Destroy main window
+#define DECIMAL_OVERLAY_HEIGHT (2 * DATE_HEIGHT)
+
+
+/**
+ * True if a double flick toggles a calendar of the current month
+ */
+#define CALENDAR_ENABLED true
+
+/**
+ * The most time between the flicks of a double flick in milliseconds
+ */
+#define CALENDAR_DOUBLE_FLICK_MS 1500
+
+/**
+ * The size of a day cell of the calendar
+ */
+#define CALENDAR_CELL_SIZE 18
+
+/**
+ * The height of the weekday header of the calendar
+ */
+#define CALENDAR_HEADER_HEIGHT 16
+
+/**
+ * The most weeks a month spans on the calendar
+ */
+#define CALENDAR_MAX_WEEKS 6
+
+
+/**
+ * True if a flick is followed by a short accelerometer sampling
+ * window to detect the watch being held still, face up
+ */
+#define GESTURE_HOLD_DETECTION_ENABLED true
+
+/**
+ * The number of samples delivered in the single batch of a hold
+ * detection window (one second at 10Hz)
+ */
+#define GESTURE_HOLD_SAMPLES 10
+
+/**
+ * The z acceleration (in milli-g) at or below which the watch is face up
+ */
+#define GESTURE_HOLD_MAX_Z -800
+
+/**
+ * The largest z acceleration swing (in milli-g) still counted as held still
+ */
+#define GESTURE_HOLD_MAX_SWING 200
+
+
+/**
+ * True if the watch vibrates the hour bits at the top of every hour
+ */
+#define HOURLY_CHIME_ENABLED false
+
+/**
+ * The length of the vibration for a 0 bit in the hourly chime in milliseconds
+ */
+#define HOURLY_CHIME_SHORT_MS 100
+
+/**
+ * The length of the vibration for a 1 bit in the hourly chime in milliseconds
+ */
+#define HOURLY_CHIME_LONG_MS 400
+
+/**
+ * The pause between bits of the hourly chime in milliseconds
+ */
+#define HOURLY_CHIME_GAP_MS 250
+
+
+/**
+ * The battery percentage at or below which hold detection is dropped
+ */
+#define GOVERNOR_NO_HOLD_BATTERY_PERCENT 10
+
+/**
+ * The battery percentage at or below which only the time is kept
+ */
+#define GOVERNOR_MINIMAL_BATTERY_PERCENT 5
+
+/**
+ * The battery percentage above a threshold needed to restore what it dropped
+ */
+#define GOVERNOR_BATTERY_HYSTERESIS_PERCENT 5
+
+/**
+ * The tick cost in milliseconds above which one more feature is dropped
+ */
+#define GOVERNOR_TICK_BUDGET_MS 50
+
+/**
+ * The number of calm ticks in a row before one feature is restored
+ */
+#define GOVERNOR_RESTORE_TICKS 15
+
+
+//--------------------------PROGRAM RESOURCES--------------------------
+
+/**
+ * The font of the time
+ */
+static GFont time_font;
+
+/**
+ * The font of the date
+ */
+static GFont date_font;
+
+
+/**
+ * The size of one bit glyph cell of a font, measured once at load
+ */
+typedef struct {
+    int16_t cell_width;
+    int16_t row_height;
+} FontMetrics;
+
+/**
+ * The metrics of the time font
+ */
+static FontMetrics time_metrics;
+
+/**
+ * The metrics of the date font
+ */
+static FontMetrics date_metrics;
+
+/**
+ * Measures the bit glyphs of the given font
+ *
+ * @param metrics the metrics to fill
+ * @param font    the font to measure
+ */
+static void measure_font(FontMetrics* metrics, GFont font);
+
+
+
+//--------------------------PROGRAM OBJECTS--------------------------
+
+/**
+ * The main window of the program
+ */
+static Window* main_window;
+
+/**
+ * Called when the given window is loaded
+ *
+ * @param window the window that was loaded
+ */
+static void on_main_window_load(Window* window);
+
+/**
+ * Called when the given window is unloaded
+ *
+ * @param window the window that was unloaded
+ */
+static void on_main_window_unload(Window* window);
+
+
+/**
+ * A value displayed on the watch, packed as an integer with its bit width
+ */
+typedef struct {
+    uint8_t value;
+    uint8_t width;
+    uint8_t flipped;
+    uint8_t first_cell;
+} BinaryField;
+
+/**
+ * The index of each field in FIELDS
+ */
+typedef enum {
+    FIELD_HOUR,
+    FIELD_MINUTE,
+    FIELD_MONTH,
+    FIELD_DAY,
+    FIELD_COUNT
+} FieldIndex;
+
+/**
+ * The layer data of a binary field layer
+ */
+typedef struct {
+    const BinaryField* field;
+    GFont font;
+} BinaryFieldView;
+
+/**
+ * Displays the hours of the time
+ */
+static Layer* hour_layer;
+
+/**
+ * Displays the minutes of the time
+ */
+static Layer* minute_layer;
+
+/**
+ * Displays the month and day of the date as one fused row
+ */
+static Layer* date_layer;
+
+/**
+ * Caches the pixels of the date layer, rebuilt when the date changes
+ */
+static GBitmap* date_cache;
+
+/**
+ * True if date_cache holds the current date
+ */
+static bool date_cache_valid;
+
+/**
+ * The index of each progress row
+ */
+typedef enum {
+    PROGRESS_DAY,
+    PROGRESS_WEEK,
+    PROGRESS_YEAR,
+    PROGRESS_COUNT
+} ProgressIndex;
+
+/**
+ * The top bits of each progress fraction
+ */
+static BinaryField progress_fields[PROGRESS_COUNT] = {
+    [PROGRESS_DAY] = { .width = PROGRESS_BINARY_LENGTH },
+    [PROGRESS_WEEK] = { .width = PROGRESS_BINARY_LENGTH },
+    [PROGRESS_YEAR] = { .width = PROGRESS_BINARY_LENGTH }
+};
+
+/**
+ * The fraction of each period elapsed, in 0.32 fixed point
+ */
+static uint32_t progress[PROGRESS_COUNT];
+
+/**
+ * The part of each fraction below 0.32 fixed point, in 1/period units
+ */
+static uint32_t progress_remainders[PROGRESS_COUNT];
+
+/**
+ * The fraction of each period one minute makes up, in 0.32 fixed point
+ */
+static uint32_t progress_increments[PROGRESS_COUNT];
+
+/**
+ * The part of each increment below 0.32 fixed point, in 1/period units
+ */
+static uint32_t progress_increment_remainders[PROGRESS_COUNT];
+
+/**
+ * The length of each period in minutes
+ */
+static uint32_t progress_periods[PROGRESS_COUNT];
+
+/**
+ * The minute of the year progress was last stepped at
+ * (INT32_MIN until the first sync)
+ */
+static int32_t progress_last_minute = INT32_MIN;
+
+/**
+ * Displays the progress rows
+ */
+static Layer* progress_layer;
+
+/**
+ * The weather as sent from the phone (src/js/app.js packs it, keep the two in sync)
+ */
+typedef struct __attribute__((__packed__)) {
+    int8_t temperature;
+    uint8_t condition;
+} WeatherPayload;
+
+/**
+ * The index of each weather row
+ */
+typedef enum {
+    WEATHER_TEMPERATURE,
+    WEATHER_CONDITION,
+    WEATHER_COUNT
+} WeatherIndex;
+
+/**
+ * The bits of the temperature and condition
+ */
+static BinaryField weather_fields[WEATHER_COUNT] = {
+    [WEATHER_TEMPERATURE] = { .width = WEATHER_TEMPERATURE_BINARY_LENGTH },
+    [WEATHER_CONDITION] = { .width = WEATHER_CONDITION_BINARY_LENGTH }
+};
+
+/**
+ * The last weather received
+ */
+static WeatherPayload weather;
+
+/**
+ * True if weather was received or restored, whether or not its rows are shown
+ */
+static bool weather_known;
+
+/**
+ * Displays the weather rows, hidden until weather is received
+ */
+static Layer* weather_layer;
+
+/**
+ * Displays the calendar of the current month over the face, hidden until toggled
+ */
+static Layer* calendar_layer;
+
+/**
+ * Caches the pixels of the calendar layer, rebuilt when the date changes
+ */
+static GBitmap* calendar_cache;
+
+/**
+ * True if calendar_cache holds the current month and day
+ */
+static bool calendar_cache_valid;
+
+/**
+ * Creates a layer which draws the given field as one glyph cell per bit,
+ * sized to exactly fit its cells
+ *
+ * @param origin  the top left of the layer
+ * @param field   the field to draw
+ * @param font    the font to draw the glyphs with
+ * @param metrics the metrics of the font
+ *
+ * @return the created layer
+ */
+static Layer* binary_field_layer_create(GPoint origin, const BinaryField* field, GFont font, const FontMetrics* metrics);
+
+/**
+ * Appends the cells of the given field to the cell arrays
+ *
+ * @param index   the index of the field
+ * @param origin  the top left of the field within its layer
+ * @param metrics the metrics of the font of the field
+ */
+static void add_field_cells(FieldIndex index, GPoint origin, const FontMetrics* metrics);
+
+/**
+ * Toggles the state of every cell whose bit flipped in the last update
+ */
+static void update_cell_states(void);
+
+/**
+ * Draws the binary field of the given layer
+ *
+ * @param layer the layer being drawn
+ * @param ctx   the graphics context to draw to
+ */
+static void draw_binary_field(Layer* layer, GContext* ctx);
+
+/**
+ * Draws the month and day fields, from the date cache when valid
+ *
+ * @param layer the date layer
+ * @param ctx   the graphics context to draw to
+ */
+static void draw_date(Layer* layer, GContext* ctx);
+
+/**
+ * Draws the progress rows as one cell per bit, filled if set
+ *
+ * @param layer the progress layer
+ * @param ctx   the graphics context to draw to
+ */
+static void draw_progress(Layer* layer, GContext* ctx);
+
+/**
+ * Draws the weather rows as one cell per bit, filled if set
+ *
+ * @param layer the weather layer
+ * @param ctx   the graphics context to draw to
+ */
+static void draw_weather(Layer* layer, GContext* ctx);
+
+/**
+ * Draws the given fields as rows of small cells, one cell per bit
+ * (most significant first), filled if set and outlined if clear
+ *
+ * @param ctx    the graphics context to draw to
+ * @param fields the fields to draw, one per row
+ * @param count  the number of fields
+ */
+static void draw_bit_rows(GContext* ctx, const BinaryField* fields, int count);
+
+/**
+ * Draws the calendar, from the calendar cache when valid
+ *
+ * @param layer the calendar layer
+ * @param ctx   the graphics context to draw to
+ */
+static void draw_calendar(Layer* layer, GContext* ctx);
+
+/**
+ * Draws the weekday header and a cell per day of the current month,
+ * today filled
+ *
+ * @param ctx    the graphics context to draw to
+ * @param bounds the bounds of the calendar layer
+ */
+static void draw_calendar_grid(GContext* ctx, GRect bounds);
+
+/**
+ * Draws the cells of the given field
+ *
+ * @param ctx             the graphics context to draw to
+ * @param field           the field to draw
+ * @param font            the font to draw the glyphs with
+ * @param slide_direction 1 if animating bits slide down, -1 if they slide up
+ */
+static void draw_binary_cells(GContext* ctx, const BinaryField* field, GFont font, int slide_direction);
+
+
+
+/**
+ * Creates a blank two color cache bitmap, 1 bit per pixel
+ *
+ * @param size the size of the bitmap
+ *
+ * @return the created bitmap
+ */
+static GBitmap* cache_bitmap_create(GSize size);
+
+/**
+ * Copies the pixels drawn in the given frame into the given cache bitmap
+ *
+ * @param ctx   the graphics context drawn to
+ * @param frame the frame of the cached layer on screen
+ * @param cache the cache bitmap, the size of the frame
+ *
+ * @return true if copied, false if the frame buffer was busy
+ */
+static bool capture_cache(GContext* ctx, GRect frame, GBitmap* cache);
+
+/**
+ * Returns true if the pixel at the given visible x of a frame buffer
+ * row is not the background color
+ *
+ * @param row the row of the frame buffer
+ * @param x   the x of the pixel, within the visible span of the row
+ *
+ * @return true if the pixel is lit
+ */
+static bool frame_buffer_pixel_lit(GBitmapDataRowInfo row, int x);
+
+/**
+ * Sets the pixel at the given x of a cache bitmap row
+ *
+ * @param row the data of the row of the cache bitmap
+ * @param x   the x of the pixel
+ * @param lit true to set the pixel to the foreground color, false for background
+ */
+static void cache_row_set_pixel(uint8_t* row, int x, bool lit);
+
+/**
+ * Sets the value of the given field, marking its layer dirty if it changed
+ *
+ * @param field the field to set
+ * @param layer the layer displaying the field
+ * @param value the new value of the field
+ *
+ * @return true if the value changed
+ */
+static bool set_binary_field(BinaryField* field, Layer* layer, int value);
+
+
+/**
+ * Slides the flipped bits into place, or NULL if not animating
+ */
+static Animation* bit_animation;
+
+/**
+ * The next bit animation, created ahead of time so ticks never allocate
+ */
+static Animation* bit_animation_prepared;
+
+/**
+ * The current frame of the bit animation, from 0 to BIT_ANIMATION_MAX_FRAMES
+ */
+static int bit_animation_frame;
+
+/**
+ * Creates the next bit animation, if not already prepared
+ */
+static void prepare_bit_animation(void);
+
+/**
+ * Starts animating the bits flipped by the last display_time, if allowed
+ */
+static void start_bit_animation(void);
+
+/**
+ * Returns true if bit flips may be animated right now
+ *
+ * @return false if the governor has dropped animations or the calendar covers the face
+ */
+static bool bit_animation_allowed(void);
+
+/**
+ * Called on every step of the bit animation
+ *
+ * @param animation the bit animation
+ * @param progress  the progress of the animation
+ */
+static void on_bit_animation_update(Animation* animation, const AnimationProgress progress);
+
+/**
+ * Called when the bit animation is stopped
+ *
+ * @param animation the bit animation
+ * @param finished  true if the animation ran to completion
+ * @param context   unused
+ */
+static void on_bit_animation_stopped(Animation* animation, bool finished, void* context);
+
+/**
+ * Marks the layers of all fields with flipped bits dirty
+ */
+static void mark_flipped_layers_dirty(void);
+
+
+/**
+ * The heap used once the window finished loading
+ */
+static size_t heap_baseline;
+
+/**
+ * Warns if the heap grew since the window loaded
+ */
+static void check_heap(void);
+
+
+/**
+ * A count of samples per fixed millisecond bucket
+ */
+typedef struct {
+    uint16_t counts[PROFILER_BUCKET_COUNT];
+} Histogram;
+
+/**
+ * The delay from each minute boundary to the end of the draw showing it
+ */
+static Histogram update_latency_histogram;
+
+/**
+ * The deviation of each gap between ticks from one minute
+ */
+static Histogram tick_jitter_histogram;
+
+/**
+ * The minute boundary awaiting its draw in ms since the epoch, or 0 if none
+ */
+static int64_t pending_minute_ms;
+
+/**
+ * The time of the last tick in ms since the epoch, or 0 if none
+ */
+static int64_t last_tick_ms;
+
+/**
+ * Returns the current time in milliseconds since the epoch
+ *
+ * @return the current time in milliseconds
+ */
+static int64_t profiler_now_ms(void);
+
+/**
+ * Records the tick jitter and starts timing the update latency
+ */
+static void profile_tick(void);
+
+/**
+ * Records the update latency if the minute being drawn is pending
+ */
+static void profile_minute_drawn(void);
+
+/**
+ * Adds a sample to the given histogram
+ *
+ * @param histogram the histogram to add to
+ * @param ms        the sample in milliseconds
+ */
+static void histogram_add(Histogram* histogram, int64_t ms);
+
+
+
+/**
+ * One hour of performance, as sent through data logging
+ * (decoded by tools/telemetry_receiver.py, keep the two in sync)
+ */
+typedef struct __attribute__((__packed__)) {
+    uint32_t hour_start;
+    uint16_t ticks;
+    uint16_t draws;
+    uint16_t bit_flips;
+    uint16_t worst_latency_ms;
+    uint16_t heap_peak_bytes;
+    uint16_t saved_ticks;
+    uint16_t update_latency_counts[PROFILER_BUCKET_COUNT];
+    uint16_t tick_jitter_counts[PROFILER_BUCKET_COUNT];
+} TelemetryRecord;
+
+/**
+ * The data logging session telemetry records are sent through
+ */
+static DataLoggingSessionRef telemetry_session;
+
+/**
+ * Sends the hour's counters and histograms as one telemetry record
+ */
+static void telemetry_log_hour(void);
+
+/**
+ * Returns the given value, clamped to fit in 16 bits
+ *
+ * @param value the value to clamp
+ *
+ * @return the clamped value
+ */
+static uint16_t saturate_u16(uint32_t value);
+
+
+/**
+ * Performance counters accumulated over a day
+ */
+typedef struct {
+    uint32_t ticks;
+    uint32_t draws;
+    uint32_t bit_flips;
+    uint32_t worst_latency_ms;
+    uint32_t heap_peak_bytes;
+    uint32_t saved_ticks;
+} PerfCounters;
+
+/**
+ * The performance counters of the current hour
+ */
+static PerfCounters perf_hour;
+
+/**
+ * The performance counters of the current day, up to the current hour
+ */
+static PerfCounters perf_today;
+
+/**
+ * The worst latency and heap peak measured over the first full day,
+ * which later days are checked against
+ */
+typedef struct {
+    uint32_t worst_latency_ms;
+    uint32_t heap_peak_bytes;
+} PerfBaseline;
+
+/**
+ * True once the current day started at midnight in this run,
+ * so its counters cover the whole day
+ */
+static bool perf_full_day;
+
+/**
+ * Records the heap used right now in the hour's peak
+ */
+static void perf_sample_heap(void);
+
+/**
+ * Sends the hour's counters as telemetry and folds them into the day's
+ */
+static void perf_end_hour(void);
+
+/**
+ * Warns about each daily counter over its budget or baseline, storing
+ * the baseline if there is none yet, then clears the counters
+ */
+static void perf_check_budgets(void);
+
+/**
+ * Warns if the given counter is over its budget by more than the threshold
+ *
+ * @param name   the name of the counter
+ * @param value  the value of the counter
+ * @param budget the budget of the counter
+ */
+static void perf_check_budget(const char* name, uint32_t value, uint32_t budget);
+
+
+/**
+ * A phase of the face timed by trace events
+ */
+typedef enum {
+    PHASE_TICK,
+    PHASE_FORMAT,
+    PHASE_SET_TEXT,
+    PHASE_UPDATE_PROC,
+    PHASE_ANIMATION_FRAME,
+    PHASE_COUNT
+} ProfilePhase;
+
+/**
+ * The beginning or end of a phase, stamped in ms since the first event
+ */
+typedef struct {
+    uint32_t time_ms;
+    uint8_t phase;
+    char type;
+} TraceEvent;
+
+/**
+ * Marks the beginning of the given phase
+ *
+ * @param phase the phase beginning
+ */
+static void profile_begin(ProfilePhase phase);
+
+/**
+ * Marks the end of the given phase
+ *
+ * @param phase the phase ending
+ */
+static void profile_end(ProfilePhase phase);
+
+/**
+ * Adds a trace event, logging the held events first if full
+ *
+ * @param phase the phase of the event
+ * @param type  'B' for begin, 'E' for end
+ */
+static void trace_event_add(ProfilePhase phase, char type);
+
+/**
+ * Logs the held trace events as Chrome trace event JSON and clears them
+ */
+static void trace_events_flush(void);
+
+
+/**
+ * The type byte starting each trace record
+ */
+typedef enum {
+    TRACE_START = 0, // version
+    TRACE_TICK = 1,  // min, hour, mday, mon, year - 1900, wday, isdst, units_changed, battery, flags
+    TRACE_TAP = 2,   // axis, direction, second
+    TRACE_HOLD = 3,  // held
+    TRACE_HEALTH = 4,  // event, asleep, second
+    TRACE_MESSAGE = 5, // key, second, length, value bytes
+    TRACE_WAKEUP = 6   // cookie, second
+} TraceRecordType;
+
+/**
+ * The flag bits of a tick record
+ */
+typedef enum {
+    TRACE_FLAG_CHARGING = 1 << 0,
+    TRACE_FLAG_QUIET_TIME = 1 << 1,
+    TRACE_FLAG_ASLEEP = 1 << 2,
+    TRACE_FLAG_SLEEP_SUPPRESSED = 1 << 3
+} TraceTickFlags;
+
+/**
+ * Records a tick and the state it was handled in
+ *
+ * @param tick_time     the time of the tick
+ * @param units_changed the units changed by the tick
+ */
+static void trace_tick(struct tm* tick_time, TimeUnits units_changed);
+
+/**
+ * Records a tap
+ *
+ * @param axis      the axis of the tap
+ * @param direction the direction of the tap
+ */
+static void trace_tap(AccelAxisType axis, int32_t direction);
+
+/**
+ * Records the outcome of a hold detection window
+ *
+ * @param held true if a hold was detected
+ */
+static void trace_hold(bool held);
+
+/**
+ * Records a health update and the sleep state peeked for it
+ *
+ * @param event the kind of update
+ */
+static void trace_health(uint8_t event);
+
+/**
+ * Records a value of a message received from the phone
+ *
+ * @param key    the key of the value
+ * @param data   the bytes of the value
+ * @param length the number of bytes, of which up to TRACE_MESSAGE_MAX_BYTES are kept
+ */
+static void trace_message(uint8_t key, const uint8_t* data, size_t length);
+
+/**
+ * Records a wakeup, fired while running or having launched the face
+ *
+ * @param cookie the cookie the wakeup was scheduled with
+ */
+static void trace_wakeup(int32_t cookie);
+
+/**
+ * Appends a record to the trace, dumping the trace first if full
+ *
+ * @param record the bytes of the record
+ * @param length the number of bytes in the record
+ */
+static void trace_append(const uint8_t* record, size_t length);
+
+/**
+ * Dumps the trace to the log as hex and empties it
+ */
+static void trace_flush(void);
+
+
+/**
+ * Displays the time and date in decimal for a few seconds after a tap
+ */
+static TextLayer* decimal_overlay_layer;
+
+/**
+ * Hides the decimal overlay, or NULL if the overlay is hidden
+ */
+static AppTimer* decimal_overlay_timer;
+
+/**
+ * Shows the decimal overlay, refreshing its text if stale
+ *
+ * @param duration_ms how long to show the overlay in milliseconds
+ */
+static void show_decimal_overlay(uint32_t duration_ms);
+
+/**
+ * Called when the decimal overlay should be hidden
+ *
+ * @param context unused
+ */
+static void on_decimal_overlay_timeout(void* context);
+
+/**
+ * Fills the decimal overlay buffer with the displayed time and date
+ */
+static void format_decimal_overlay(void);
+
+/**
+ * Shows the calendar if hidden, else hides it
+ */
+static void toggle_calendar(void);
+
+/**
+ * A wrist gesture recognized from accelerometer events
+ */
+typedef enum {
+    GESTURE_FLICK,
+    GESTURE_FLICK_AND_HOLD,
+    GESTURE_DOUBLE_FLICK
+} Gesture;
+
+/**
+ * The time of the last tap not part of a double flick in milliseconds, or 0
+ */
+static int64_t last_tap_ms;
+
+/**
+ * True while the accelerometer is sampling for a hold detection window
+ */
+static bool gesture_sampling;
+
+/**
+ * Called when a gesture is recognized
+ *
+ * @param gesture the gesture that was recognized
+ */
+static void on_gesture(Gesture gesture);
+
+/**
+ * Called when the watch is tapped or shaken
+ *
+ * @param axis      the axis the tap was detected on
+ * @param direction the direction of the tap along the axis
+ */
+static void on_tap(AccelAxisType axis, int32_t direction);
+
+/**
+ * Called with the batch of samples of a hold detection window
+ *
+ * @param data        the accelerometer samples
+ * @param num_samples the number of samples in the batch
+ */
+static void on_gesture_samples(AccelData* data, uint32_t num_samples);
+
+
+/**
+ * How far optional features are stepped down, each level
+ * dropping one more feature on top of the levels before it
+ */
+typedef enum {
+    GOVERNOR_FULL,
+    GOVERNOR_NO_ANIMATION,
+    GOVERNOR_NO_HOLD,
+    GOVERNOR_MINIMAL
+} GovernorLevel;
+
+/**
+ * The current governor level
+ */
+static GovernorLevel governor_level;
+
+/**
+ * The number of ticks in a row that called for a lower level than the current
+ */
+static uint8_t governor_calm_ticks;
+
+/**
+ * Returns true if the feature dropped at the given level is still allowed
+ *
+ * @param level the level the feature is dropped at
+ *
+ * @return true if the governor is below the given level
+ */
+static bool governor_allows(GovernorLevel level);
+
+/**
+ * Returns the level the current battery and quiet time call for
+ *
+ * @return the level called for
+ */
+static GovernorLevel governor_target_level(void);
+
+/**
+ * Steps the governor after a tick, dropping features at once
+ * and restoring them one at a time once things are calm
+ *
+ * @param tick_cost_ms how long the tick took in milliseconds
+ */
+static void governor_update(int64_t tick_cost_ms);
+
+/**
+ * Sets the governor level
+ *
+ * @param level the new level
+ */
+static void governor_set_level(GovernorLevel level);
+
+
+/**
+ * True while minute ticks are suppressed because the wearer is asleep
+ */
+static bool sleep_suppressed;
+
+/**
+ * The time of the last wakeup while minute ticks are suppressed
+ */
+static time_t sleep_last_wakeup;
+
+/**
+ * Returns true if the wearer is asleep
+ *
+ * @return true if health tracking reports sleep
+ */
+static bool sleep_active(void);
+
+/**
+ * Suppresses or resumes minute ticks to match the wearer being asleep
+ */
+static void sleep_update(void);
+
+/**
+ * Counts the minute ticks skipped since the last wakeup
+ *
+ * @param ticked true if this wakeup is itself a tick
+ */
+static void sleep_count_saved_ticks(bool ticked);
+
+/**
+ * Catches the display up to the current time after ticks were skipped
+ */
+static void sleep_catch_up(void);
+
+#if defined(PBL_HEALTH)
+/**
+ * Called when health tracking has an update
+ *
+ * @param event   the kind of update
+ * @param context unused
+ */
+static void on_health_event(HealthEventType event, void* context);
+#endif
+
+
+/**
+ * The time the countdown ends, or 0 if not counting down
+ */
+static time_t countdown_target;
+
+/**
+ * The wakeup scheduled for the end of the countdown
+ */
+static WakeupId countdown_wakeup;
+
+/**
+ * The whole hours left in the countdown
+ */
+static uint16_t countdown_hours;
+
+/**
+ * The minutes left in the countdown past the whole hours
+ */
+static uint8_t countdown_minutes;
+
+/**
+ * The minute (since the epoch) the countdown was last stepped at
+ */
+static int32_t countdown_last_minute;
+
+/**
+ * Starts counting down to the given time, replacing any countdown
+ *
+ * @param target the time to count down to, or 0 to cancel
+ */
+static void countdown_set(time_t target);
+
+/**
+ * Resumes the countdown saved by the last run
+ */
+static void countdown_restore(void);
+
+/**
+ * Sets the time left from the countdown target
+ *
+ * @param minute the current minute (since the epoch)
+ */
+static void countdown_sync(int32_t minute);
+
+/**
+ * Steps the time left to the given time, by one minute if
+ * it is the minute after the last step, else by resyncing
+ *
+ * @param now the current time
+ */
+static void countdown_step(time_t now);
+
+/**
+ * Ends the countdown
+ *
+ * @param alert true if the end is vibrated
+ */
+static void countdown_finish(bool alert);
+
+/**
+ * Called when a scheduled wakeup fires while the face is running
+ *
+ * @param id     the id of the wakeup
+ * @param cookie the cookie the wakeup was scheduled with
+ */
+static void on_wakeup(WakeupId id, int32_t cookie);
+
+/**
+ * Shows the given weather, saving it for the next run if it changed
+ *
+ * @param payload the weather to show
+ */
+static void weather_set(const WeatherPayload* payload);
+
+/**
+ * Shows the given weather
+ *
+ * @param payload the weather to show
+ */
+static void weather_show(const WeatherPayload* payload);
+
+/**
+ * Shows the weather saved by the last run
+ */
+static void weather_restore(void);
+
+/**
+ * Called when a message is received from the phone
+ *
+ * @param iterator the contents of the message
+ * @param context  unused
+ */
+static void on_message_received(DictionaryIterator* iterator, void* context);
+
+
+/**
+ * Called on every tick
+ *
+ * @param tick_time     the current time
+ * @param units_changed the amount of time since the last tick
+ */
+static void on_tick(struct tm* tick_time, TimeUnits units_changed);
+
+/**
+ * Displays the time on the watch
+ *
+ * @param tick_time the time to display on the watch
+ */
+static void display_time(struct tm* tick_time);
+
+/**
+ * Logs decimal and binary representations of time to console
+ *
+ * @param tick_time the time being displayed
+ */
+static void debug_time(struct tm* tick_time);
+
+/**
+ * Advances the civil time to match the given tick time
+ *
+ * @param tick_time the time reported by the tick timer service
+ *
+ * @return the civil time to display
+ */
+static struct tm* civil_time_step(struct tm* tick_time);
+
+/**
+ * Sets the civil time to the given time
+ *
+ * @param tick_time the time to set the civil time to
+ */
+static void civil_time_sync(struct tm* tick_time);
+
+/**
+ * Advances the civil time by one minute, carrying into the
+ * hour, day, month and year as needed
+ */
+static void civil_time_advance_minute(void);
+
+/**
+ * Returns the number of days in the month of the civil time
+ *
+ * @return the number of days in the current month
+ */
+static int civil_time_days_in_month(void);
+
+/**
+ * Returns true if the year of the civil time is a leap year
+ *
+ * @return true if the current year has a leap day
+ */
+static bool civil_time_is_leap_year(void);
+
+/**
+ * Steps the progress fractions to the given time, by one minute's
+ * increment if it is the minute after the last step, else by resyncing
+ *
+ * @param tick_time the time being displayed
+ */
+static void progress_step(struct tm* tick_time);
+
+/**
+ * Sets the progress fractions exactly from the given time
+ *
+ * @param tick_time     the time being displayed
+ * @param minute_of_day the minutes since midnight of the time
+ */
+static void progress_sync(struct tm* tick_time, int32_t minute_of_day);
+
+/**
+ * Returns the hours of the tick_time formatted correctly
+ *
+ * @param tick_time the tick_time to get the hours from
+ *
+ * @return the hours formatted correctly
+ */
+static int tm_get_hours(struct tm* tick_time);
+
+/**
+ * Returns the months of the tick_time formatted correctly
+ *
+ * @param tick_time the tick_time to get the months from
+ *
+ * @return the months formatted correctly
+ */
+static int tm_get_months(struct tm* tick_time);
+
+
+
+//--------------------------BINARY FORMATTERS--------------------------
+
+/**
+ * Returns the ASCII digit ('0' or '1') of the given bit of the value
+ *
+ * @param value the value to read the bit from
+ * @param bit   the index of the bit, 0 being the least significant
+ */
+#define BINARY_DIGIT(value, bit) ((char)('0' + (((value) >> (bit)) & 1)))
+
+/**
+ * Writes the lowest N bits of the value to the first N chars of the
+ * buffer, most significant bit first. Each width expands into the
+ * next smaller one, so the whole write is unrolled at compile time.
+ */
+#define BINARY_DIGITS_1(buffer, value) ((buffer)[0] = BINARY_DIGIT(value, 0))
+#define BINARY_DIGITS_2(buffer, value) ((buffer)[0] = BINARY_DIGIT(value, 1), BINARY_DIGITS_1((buffer) + 1, value))
+#define BINARY_DIGITS_3(buffer, value) ((buffer)[0] = BINARY_DIGIT(value, 2), BINARY_DIGITS_2((buffer) + 1, value))
+#define BINARY_DIGITS_4(buffer, value) ((buffer)[0] = BINARY_DIGIT(value, 3), BINARY_DIGITS_3((buffer) + 1, value))
+#define BINARY_DIGITS_5(buffer, value) ((buffer)[0] = BINARY_DIGIT(value, 4), BINARY_DIGITS_4((buffer) + 1, value))
+#define BINARY_DIGITS_6(buffer, value) ((buffer)[0] = BINARY_DIGIT(value, 5), BINARY_DIGITS_5((buffer) + 1, value))
+
+/**
+ * Defines format_as_binary_<width>, which fills a buffer of
+ * width + 1 chars with the given value represented in binary
+ *
+ * @param width the number of bits to write
+ */
+#define DEFINE_FORMAT_AS_BINARY(width)                                  \
+    static inline void format_as_binary_##width(char* buffer, int value) { \
+        BINARY_DIGITS_##width(buffer, value);                           \
+        buffer[width] = '\0';                                           \
+    }
+
+/**
+ * Fills the given buffer with the given value represented in binary,
+ * using the formatter specialized for the given width
+ *
+ * @param width  the number of bits to write (a *_BINARY_LENGTH constant)
+ * @param buffer the buffer to write to, at least width + 1 chars long
+ * @param value  the value to write as binary
+ */
+#define FORMAT_AS_BINARY(width, buffer, value) FORMAT_AS_BINARY_EXPANDED(width, buffer, value)
+#define FORMAT_AS_BINARY_EXPANDED(width, buffer, value) format_as_binary_##width(buffer, value)
+
+DEFINE_FORMAT_AS_BINARY(4)
+DEFINE_FORMAT_AS_BINARY(5)
+DEFINE_FORMAT_AS_BINARY(6)
+
+
+
+//--------------------------BINARY FIELDS--------------------------
+
+/**
+ * The glyphs drawn for a 0 bit and a 1 bit
+ */
+static const char* const BIT_GLYPHS[2] = { "0", "1" };
+
+/**
+ * The hours being displayed
+ */
+static BinaryField hour_field = { .width = HOUR_BINARY_LENGTH };
+
+/**
+ * The minutes being displayed
+ */
+static BinaryField minute_field = { .width = MINUTE_BINARY_LENGTH };
+
+/**
+ * The month being displayed
+ */
+static BinaryField month_field = { .width = MONTH_BINARY_LENGTH };
+
+/**
+ * The day being displayed
+ */
+static BinaryField day_field = { .width = DAY_BINARY_LENGTH };
+
+/**
+ * Every field, indexed by FieldIndex
+ */
+static BinaryField* const FIELDS[FIELD_COUNT] = {
+    [FIELD_HOUR] = &hour_field,
+    [FIELD_MINUTE] = &minute_field,
+    [FIELD_MONTH] = &month_field,
+    [FIELD_DAY] = &day_field
+};
+
+
+//--------------------------BIT CELLS--------------------------
+
+/**
+ * The rect of each bit cell within its layer, as parallel arrays
+ */
+static int16_t cell_x[CELL_COUNT];
+static int16_t cell_y[CELL_COUNT];
+static int16_t cell_w[CELL_COUNT];
+static int16_t cell_h[CELL_COUNT];
+
+/**
+ * The field and bit each cell displays
+ */
+static uint8_t cell_field[CELL_COUNT];
+static uint8_t cell_bit[CELL_COUNT];
+
+/**
+ * The bit each cell last displayed
+ */
+static uint8_t cell_state[CELL_COUNT];
+
+/**
+ * The number of cells added so far
+ */
+static uint8_t cell_count;
+
+
+//--------------------------BINARY BUFFERS--------------------------
+
+/**
+ * Stores the binary representation of the hours (for logging only)
+ */
+static char hour_binary_buffer[HOUR_BINARY_LENGTH + 1];
+
+/**
+ * Stores the binary representation of the minutes (for logging only)
+ */
+static char minute_binary_buffer[MINUTE_BINARY_LENGTH + 1];
+
+/**
+ * Stores the binary representation of the month (for logging only)
+ */
+static char month_binary_buffer[MONTH_BINARY_LENGTH + 1];
+
+/**
+ * Stores the binary representation of the day (for logging only)
+ */
+static char day_binary_buffer[DAY_BINARY_LENGTH + 1];
+
+
+//--------------------------CIVIL TIME--------------------------
+
+/**
+ * The number of days in each month of a non-leap year
+ */
+static const uint8_t DAYS_IN_MONTH[MONTHS_PER_YEAR] = {
+    31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+
+/**
+ * The time being displayed, advanced one minute per tick
+ */
+static struct tm civil_time;
+
+/**
+ * True if civil_time has been synced and can be advanced
+ */
+static bool civil_time_valid = false;
+
+
+//--------------------------HOURLY CHIME PATTERNS--------------------------
+
+/**
+ * The vibration length of the given bit of the given hour
+ */
+#define HOURLY_CHIME_BIT(hour, bit) ((((hour) >> (bit)) & 1) ? HOURLY_CHIME_LONG_MS : HOURLY_CHIME_SHORT_MS)
+
+/**
+ * The on/off segments of the chime of the given hour, one vibration
+ * per bit of HOUR_BINARY_LENGTH, most significant bit first
+ */
+#define HOURLY_CHIME_SEGMENTS(hour) {                             \
+    HOURLY_CHIME_BIT(hour, 4), HOURLY_CHIME_GAP_MS,               \
+    HOURLY_CHIME_BIT(hour, 3), HOURLY_CHIME_GAP_MS,               \
+    HOURLY_CHIME_BIT(hour, 2), HOURLY_CHIME_GAP_MS,               \
+    HOURLY_CHIME_BIT(hour, 1), HOURLY_CHIME_GAP_MS,               \
+    HOURLY_CHIME_BIT(hour, 0)                                     \
+}
+
+/**
+ * The vibration pattern of the given hour
+ */
+#define HOURLY_CHIME_PATTERN(hour) {                              \
+    .durations = HOURLY_CHIME_DURATIONS[hour],                    \
+    .num_segments = ARRAY_LENGTH(HOURLY_CHIME_DURATIONS[hour])    \
+}
+
+/**
+ * The on/off segments of the chime of every hour
+ */
+static const uint32_t HOURLY_CHIME_DURATIONS[HOURS_PER_DAY][2 * HOUR_BINARY_LENGTH - 1] = {
+    HOURLY_CHIME_SEGMENTS(0),  HOURLY_CHIME_SEGMENTS(1),  HOURLY_CHIME_SEGMENTS(2),
+    HOURLY_CHIME_SEGMENTS(3),  HOURLY_CHIME_SEGMENTS(4),  HOURLY_CHIME_SEGMENTS(5),
+    HOURLY_CHIME_SEGMENTS(6),  HOURLY_CHIME_SEGMENTS(7),  HOURLY_CHIME_SEGMENTS(8),
+    HOURLY_CHIME_SEGMENTS(9),  HOURLY_CHIME_SEGMENTS(10), HOURLY_CHIME_SEGMENTS(11),
+    HOURLY_CHIME_SEGMENTS(12), HOURLY_CHIME_SEGMENTS(13), HOURLY_CHIME_SEGMENTS(14),
+    HOURLY_CHIME_SEGMENTS(15), HOURLY_CHIME_SEGMENTS(16), HOURLY_CHIME_SEGMENTS(17),
+    HOURLY_CHIME_SEGMENTS(18), HOURLY_CHIME_SEGMENTS(19), HOURLY_CHIME_SEGMENTS(20),
+    HOURLY_CHIME_SEGMENTS(21), HOURLY_CHIME_SEGMENTS(22), HOURLY_CHIME_SEGMENTS(23)
+};
+
+/**
+ * The vibration pattern of every hour, indexed by displayed hour
+ */
+static const VibePattern HOURLY_CHIME_PATTERNS[HOURS_PER_DAY] = {
+    HOURLY_CHIME_PATTERN(0),  HOURLY_CHIME_PATTERN(1),  HOURLY_CHIME_PATTERN(2),
+    HOURLY_CHIME_PATTERN(3),  HOURLY_CHIME_PATTERN(4),  HOURLY_CHIME_PATTERN(5),
+    HOURLY_CHIME_PATTERN(6),  HOURLY_CHIME_PATTERN(7),  HOURLY_CHIME_PATTERN(8),
+    HOURLY_CHIME_PATTERN(9),  HOURLY_CHIME_PATTERN(10), HOURLY_CHIME_PATTERN(11),
+    HOURLY_CHIME_PATTERN(12), HOURLY_CHIME_PATTERN(13), HOURLY_CHIME_PATTERN(14),
+    HOURLY_CHIME_PATTERN(15), HOURLY_CHIME_PATTERN(16), HOURLY_CHIME_PATTERN(17),
+    HOURLY_CHIME_PATTERN(18), HOURLY_CHIME_PATTERN(19), HOURLY_CHIME_PATTERN(20),
+    HOURLY_CHIME_PATTERN(21), HOURLY_CHIME_PATTERN(22), HOURLY_CHIME_PATTERN(23)
+};
+
+
+//--------------------------CACHE PALETTE--------------------------
+
+#if defined(PBL_COLOR)
+/**
+ * The colors of cache bitmaps, background then foreground
+ */
+static GColor cache_palette[2];
+#endif
+
+
+//--------------------------PROFILER BUCKETS--------------------------
+
+/**
+ * The upper limit in milliseconds of each histogram bucket but the last,
+ * which counts everything above the second to last limit
+ */
+static const uint16_t PROFILER_BUCKET_LIMITS_MS[PROFILER_BUCKET_COUNT - 1] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000
+};
+
+
+//--------------------------TRACE EVENT BUFFERS--------------------------
+
+/**
+ * The name of each phase in trace events
+ */
+static const char* const PHASE_NAMES[PHASE_COUNT] = {
+    [PHASE_TICK] = "tick",
+    [PHASE_FORMAT] = "format",
+    [PHASE_SET_TEXT] = "set_text",
+    [PHASE_UPDATE_PROC] = "update_proc",
+    [PHASE_ANIMATION_FRAME] = "animation_frame"
+};
+
+/**
+ * Stores trace events not yet logged
+ */
+static TraceEvent trace_events[TRACE_EVENT_COUNT];
+
+/**
+ * The number of trace events held
+ */
+static int trace_event_count;
+
+/**
+ * The time of the first trace event in ms since the epoch, or 0 if none
+ */
+static int64_t trace_events_epoch_ms;
+
+
+//--------------------------DECIMAL OVERLAY BUFFERS--------------------------
+
+/**
+ * Stores the decimal time and date shown by the overlay ("14:32\n10/15")
+ */
+static char decimal_overlay_buffer[16];
+
+/**
+ * True if the decimal overlay buffer no longer matches the displayed time
+ */
+static bool decimal_overlay_stale = true;
+
+
+//--------------------------CALENDAR LABELS--------------------------
+
+/**
+ * The initial of each weekday, starting from sunday
+ */
+static const char* WEEKDAY_INITIALS[DAYS_PER_WEEK] = { "S", "M", "T", "W", "T", "F", "S" };
+
+
+
+//--------------------------TRACE BUFFERS--------------------------
+
+/**
+ * Stores trace records not yet dumped to the log
+ */
+static uint8_t trace_buffer[TRACE_BUFFER_SIZE];
+
+/**
+ * The number of bytes in the trace buffer
+ */
+static size_t trace_length;
+
+/**
+ * True once the start record has been written
+ */
+static bool trace_started;
+
+/**
+ * Stores one log line of hex encoded trace
+ */
+static char trace_log_buffer[2 * TRACE_LOG_LINE_BYTES + 1];
+
+
+//--------------------------DEBUG BUFFERS--------------------------
+
+/**
+ * String representation of hour value for debug purposes
+ */
+static char hour_debug_buffer[32];
+
+/**
+ * String representation of minute value for debug purposes
+ */
+static char minute_debug_buffer[32];
+
+/**
+ * String representation of month value for debug purposes
+ */
+static char month_debug_buffer[32];
+
+/**
+ * String representation of day value for debug purposes
+ */
+static char day_debug_buffer[32];
+
+
+
+//--------------------------BINARY TIME FUNCTIONS--------------------------
+
+/**
+ * Displays the time and date on the watch
+ *
+ * @param tick_time the time to display on the watch
+ */
+static void display_time(struct tm* tick_time) {
+    profile_begin(PHASE_FORMAT);
+    
+    // Set binary fields with the time values, or the time left if counting down
+    // (held at the most the hour field can show until under it)
+    if (countdown_target) {
+        bool over = countdown_hours > COUNTDOWN_MAX_HOURS;
+        set_binary_field(&hour_field, hour_layer, over ? COUNTDOWN_MAX_HOURS : countdown_hours);
+        set_binary_field(&minute_field, minute_layer, over ? MINUTES_PER_HOUR - 1 : countdown_minutes);
+    } else {
+        set_binary_field(&hour_field, hour_layer, tm_get_hours(tick_time));
+        set_binary_field(&minute_field, minute_layer, tick_time->tm_min);
+    }
+    
+    // Set binary fields with the date values, rebuilding the date cache if either changed
+    if (set_binary_field(&month_field, date_layer, tm_get_months(tick_time))
+      | set_binary_field(&day_field, date_layer, tick_time->tm_mday)) {
+        date_cache_valid = false;
+        
+        // Rebuild the calendar too, when next shown
+        if (CALENDAR_ENABLED) {
+            calendar_cache_valid = false;
+            layer_mark_dirty(calendar_layer);
+        }
+    }
+    
+    // Apply flipped bits to the cells
+    update_cell_states();
+    
+    // Step progress rows, unless down to the minimal face
+    if (PROGRESS_ROWS_ENABLED && governor_allows(GOVERNOR_MINIMAL)) {
+        progress_step(tick_time);
+    }
+    
+    // Log time, along with new binary values, to console
+    if (DEBUG_TIME_ENABLED) {
+        debug_time(tick_time);
+    }
+    
+    profile_end(PHASE_FORMAT);
+}
+
+/**
+ * Sets the value of the given field, marking its layer dirty if it changed
+ *
+ * @param field the field to set
+ * @param layer the layer displaying the field
+ * @param value the new value of the field
+ *
+ * @return true if the value changed
+ */
+static bool set_binary_field(BinaryField* field, Layer* layer, int value) {
+    // Remember which bits flipped for the animation
+    field->flipped = field->value ^ value;
+    
+    // Return if the value is unchanged
+    if (!field->flipped) {
+        return false;
+    }
+    
+    // Set value and redraw layer
+    field->value = value;
+    layer_mark_dirty(layer);
+    return true;
+}
+
+/**
+ * Returns the hours of the tick_time formatted correctly
+ *
+ * @param tick_time the tick_time to get the hours from
+ *
+ * @return the hours formatted correctly
+ */
+static int tm_get_hours(struct tm* tick_time) {
+    // Get hours from tick_time
+    int hours = tick_time->tm_hour;
+    
+    // If clock is 24 hour style, return hours
+    // Else if hour mod 12 is 0, return 12 
+    // (as 0 is represented by 12 in 12 hour clock)
+    // Else return hours mod 12
+    return clock_is_24h_style() ? hours 
+                                : (hours % 12 == 0 ? 12 
+                                                   : hours % 12);
+}
+
+/**
+ * Returns the months of the tick_time formatted correctly
+ *
+ * @param tick_time the tick_time to get the months from
+ *
+ * @return the months formatted correctly
+ */
+static int tm_get_months(struct tm* tick_time) {
+    return tick_time->tm_mon + 1;
+}
+
+
+
+//--------------------------CIVIL TIME FUNCTIONS--------------------------
+
+/**
+ * Advances the civil time to match the given tick time
+ *
+ * @param tick_time the time reported by the tick timer service
+ *
+ * @return the civil time to display
+ */
+static struct tm* civil_time_step(struct tm* tick_time) {
+    // Resync if there is nothing to advance from, or if the
+    // daylight saving rule flipped since the last sync
+    if (!civil_time_valid || civil_time.tm_isdst != tick_time->tm_isdst) {
+        civil_time_sync(tick_time);
+        return &civil_time;
+    }
+    
+    // Step forward one minute
+    civil_time_advance_minute();
+    
+    // Resync if a tick was missed or the clock was set
+    if (civil_time.tm_min != tick_time->tm_min
+     || civil_time.tm_hour != tick_time->tm_hour
+     || civil_time.tm_mday != tick_time->tm_mday
+     || civil_time.tm_mon != tick_time->tm_mon
+     || civil_time.tm_year != tick_time->tm_year) {
+        civil_time_sync(tick_time);
+    }
+    
+    // Return stepped time
+    return &civil_time;
+}
+
+/**
+ * Sets the civil time to the given time
+ *
+ * @param tick_time the time to set the civil time to
+ */
+static void civil_time_sync(struct tm* tick_time) {
+    civil_time = *tick_time;
+    civil_time.tm_sec = 0;
+    civil_time_valid = true;
+}
+
+/**
+ * Advances the civil time by one minute, carrying into the
+ * hour, day, month and year as needed
+ */
+static void civil_time_advance_minute(void) {
+    // Advance minute, return if no carry
+    if (++civil_time.tm_min < MINUTES_PER_HOUR) {
+        return;
+    }
+    civil_time.tm_min = 0;
+    
+    // Advance hour, return if no carry
+    if (++civil_time.tm_hour < HOURS_PER_DAY) {
+        return;
+    }
+    civil_time.tm_hour = 0;
+    
+    // Advance weekday and day of year
+    if (++civil_time.tm_wday == DAYS_PER_WEEK) {
+        civil_time.tm_wday = 0;
+    }
+    civil_time.tm_yday++;
+    
+    // Advance day, return if no carry
+    if (++civil_time.tm_mday <= civil_time_days_in_month()) {
+        return;
+    }
+    civil_time.tm_mday = 1;
+    
+    // Advance month, return if no carry
+    if (++civil_time.tm_mon < MONTHS_PER_YEAR) {
+        return;
+    }
+    civil_time.tm_mon = 0;
+    
+    // Advance year
+    civil_time.tm_yday = 0;
+    civil_time.tm_year++;
+}
+
+/**
+ * Returns the number of days in the month of the civil time
+ *
+ * @return the number of days in the current month
+ */
+static int civil_time_days_in_month(void) {
+    // Get days from table
+    int days = DAYS_IN_MONTH[civil_time.tm_mon];
+    
+    // Add leap day to february of leap years
+    // (the calendar calls this on any day, so check the month first)
+    if (civil_time.tm_mon == 1 && civil_time_is_leap_year()) {
+        days++;
+    }
+    
+    // Return days in month
+    return days;
+}
+
+/**
+ * Returns true if the year of the civil time is a leap year
+ *
+ * @return true if the current year has a leap day
+ */
+static bool civil_time_is_leap_year(void) {
+    int year = civil_time.tm_year + 1900;
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+
+
+//--------------------------PROGRESS FUNCTIONS--------------------------
+
+/**
+ * Steps the progress fractions to the given time, by one minute's
+ * increment if it is the minute after the last step, else by resyncing
+ *
+ * @param tick_time the time being displayed
+ */
+static void progress_step(struct tm* tick_time) {
+    int32_t minute_of_day = tick_time->tm_hour * MINUTES_PER_HOUR + tick_time->tm_min;
+    int32_t minute = tick_time->tm_yday * MINUTES_PER_DAY + minute_of_day;
+    
+    // Return if already stepped to this minute
+    if (minute == progress_last_minute) {
+        return;
+    }
+    
+    // Add a minute to each fraction, carrying the remainders so the
+    // sums stay exact, and resync at midnight (and so at the new year)
+    // or after a gap
+    if (minute == progress_last_minute + 1 && minute_of_day) {
+        for (int index = 0; index < PROGRESS_COUNT; index++) {
+            progress[index] += progress_increments[index];
+            progress_remainders[index] += progress_increment_remainders[index];
+            if (progress_remainders[index] >= progress_periods[index]) {
+                progress_remainders[index] -= progress_periods[index];
+                progress[index]++;
+            }
+        }
+    } else {
+        progress_sync(tick_time, minute_of_day);
+    }
+    progress_last_minute = minute;
+    
+    // Show top bits, redrawing only if any flipped
+    for (int index = 0; index < PROGRESS_COUNT; index++) {
+        set_binary_field(&progress_fields[index], progress_layer,
+                         progress[index] >> (32 - PROGRESS_BINARY_LENGTH));
+    }
+}
+
+/**
+ * Sets the progress fractions exactly from the given time
+ *
+ * @param tick_time     the time being displayed
+ * @param minute_of_day the minutes since midnight of the time
+ */
+static void progress_sync(struct tm* tick_time, int32_t minute_of_day) {
+    // Get the minutes elapsed and the length of each period
+    uint32_t elapsed[PROGRESS_COUNT] = {
+        [PROGRESS_DAY] = minute_of_day,
+        [PROGRESS_WEEK] = tick_time->tm_wday * MINUTES_PER_DAY + minute_of_day,
+        [PROGRESS_YEAR] = tick_time->tm_yday * MINUTES_PER_DAY + minute_of_day
+    };
+    progress_periods[PROGRESS_DAY] = MINUTES_PER_DAY;
+    progress_periods[PROGRESS_WEEK] = MINUTES_PER_WEEK;
+    progress_periods[PROGRESS_YEAR] = (DAYS_PER_YEAR + civil_time_is_leap_year()) * MINUTES_PER_DAY;
+    
+    // Divide into fractions once, minutes are added from here on
+    for (int index = 0; index < PROGRESS_COUNT; index++) {
+        uint64_t scaled = (uint64_t)elapsed[index] << 32;
+        progress[index] = scaled / progress_periods[index];
+        progress_remainders[index] = scaled % progress_periods[index];
+        progress_increments[index] = ((uint64_t)1 << 32) / progress_periods[index];
+        progress_increment_remainders[index] = ((uint64_t)1 << 32) % progress_periods[index];
+    }
+}
+
+
+
+//--------------------------FONT METRICS--------------------------
+
+/**
+ * Measures the bit glyphs of the given font
+ *
+ * @param metrics the metrics to fill
+ * @param font    the font to measure
+ */
+static void measure_font(FontMetrics* metrics, GFont font) {
+    // Start empty
+    metrics->cell_width = 0;
+    metrics->row_height = 0;
+    
+    // Grow to fit the laid out size of each glyph
+    for (int i = 0; i < 2; i++) {
+        GSize size = graphics_text_layout_get_content_size(BIT_GLYPHS[i], font, FONT_MEASURE_BOX,
+                                                           GTextOverflowModeFill, GTextAlignmentLeft);
+        if (size.w > metrics->cell_width) {
+            metrics->cell_width = size.w;
+        }
+        if (size.h > metrics->row_height) {
+            metrics->row_height = size.h;
+        }
+    }
+}
+
+
+
+//--------------------------BINARY FIELD LAYERS--------------------------
+
+/**
+ * Creates a layer which draws the given field as one glyph cell per bit,
+ * sized to exactly fit its cells
+ *
+ * @param origin  the top left of the layer
+ * @param field   the field to draw
+ * @param font    the font to draw the glyphs with
+ * @param metrics the metrics of the font
+ *
+ * @return the created layer
+ */
+static Layer* binary_field_layer_create(GPoint origin, const BinaryField* field, GFont font, const FontMetrics* metrics) {
+    // Create layer with room for the view
+    Layer* layer = layer_create_with_data(GRect(origin.x, origin.y,
+                                                field->width * metrics->cell_width,
+                                                metrics->row_height),
+                                          sizeof(BinaryFieldView));
+    
+    // Fill view
+    BinaryFieldView* view = layer_get_data(layer);
+    view->field = field;
+    view->font = font;
+    
+    // Set drawing procedure and return
+    layer_set_update_proc(layer, draw_binary_field);
+    return layer;
+}
+
+/**
+ * Draws the binary field of the given layer
+ *
+ * @param layer the layer being drawn
+ * @param ctx   the graphics context to draw to
+ */
+static void draw_binary_field(Layer* layer, GContext* ctx) {
+    profile_begin(PHASE_UPDATE_PROC);
+    
+    // Every render of the window draws the hour layer first,
+    // so count renders there rather than in every update proc
+    BinaryFieldView* view = layer_get_data(layer);
+    if (view->field == &hour_field) {
+        perf_hour.draws++;
+    }
+    
+    // Draw field of view
+    draw_binary_cells(ctx, view->field, view->font, 1);
+    
+    // The minute changes every tick, so its final draw
+    // marks when the new time became visible
+    if (PROFILER_ENABLED && view->field == &minute_field && !bit_animation) {
+        profile_minute_drawn();
+    }
+    
+    profile_end(PHASE_UPDATE_PROC);
+}
+
+/**
+ * Draws the month and day fields, from the date cache when valid
+ *
+ * @param layer the date layer
+ * @param ctx   the graphics context to draw to
+ */
+static void draw_date(Layer* layer, GContext* ctx) {
+    profile_begin(PHASE_UPDATE_PROC);
+    
+    // If cached, blit cached date
+    // Else draw the date, then cache it
+    if (date_cache_valid) {
+        graphics_draw_bitmap_in_rect(ctx, date_cache, layer_get_bounds(layer));
+    } else {
+        // Draw month and day rows, sliding animating bits away
+        // from each other so the layer clips them
+        draw_binary_cells(ctx, &month_field, date_font, -1);
+        draw_binary_cells(ctx, &day_field, date_font, 1);
+        
+        // Cache drawn date, unless in the middle of animating it
+        if (!bit_animation || !(month_field.flipped | day_field.flipped)) {
+            date_cache_valid = capture_cache(ctx, layer_get_frame(layer), date_cache);
+        }
+    }
+    
+    profile_end(PHASE_UPDATE_PROC);
+}
+
+/**
+ * Draws the progress rows as one cell per bit, filled if set
+ *
+ * @param layer the progress layer
+ * @param ctx   the graphics context to draw to
+ */
+static void draw_progress(Layer* layer, GContext* ctx) {
+    profile_begin(PHASE_UPDATE_PROC);
+    draw_bit_rows(ctx, progress_fields, PROGRESS_COUNT);
+    profile_end(PHASE_UPDATE_PROC);
+}
+
+/**
+ * Draws the weather rows as one cell per bit, filled if set
+ *
+ * @param layer the weather layer
+ * @param ctx   the graphics context to draw to
+ */
+static void draw_weather(Layer* layer, GContext* ctx) {
+    profile_begin(PHASE_UPDATE_PROC);
+    draw_bit_rows(ctx, weather_fields, WEATHER_COUNT);
+    profile_end(PHASE_UPDATE_PROC);
+}
+
+/**
+ * Draws the given fields as rows of small cells, one cell per bit
+ * (most significant first), filled if set and outlined if clear
+ *
+ * @param ctx    the graphics context to draw to
+ * @param fields the fields to draw, one per row
+ * @param count  the number of fields
+ */
+static void draw_bit_rows(GContext* ctx, const BinaryField* fields, int count) {
+    // Set colors
+    graphics_context_set_fill_color(ctx, GColorGreen);
+    graphics_context_set_stroke_color(ctx, GColorGreen);
+    
+    // Draw each row, most significant bit first
+    for (int index = 0; index < count; index++) {
+        const BinaryField* field = &fields[index];
+        for (int bit = 0; bit < field->width; bit++) {
+            GRect cell = GRect(bit * BIT_ROW_CELL_WIDTH, index * BIT_ROW_HEIGHT,
+                               BIT_ROW_CELL_WIDTH - 2, BIT_ROW_CELL_HEIGHT);
+            if ((field->value >> (field->width - 1 - bit)) & 1) {
+                graphics_fill_rect(ctx, cell, 0, GCornerNone);
+            } else {
+                graphics_draw_rect(ctx, cell);
+            }
+        }
+    }
+}
+
+/**
+ * Draws the calendar, from the calendar cache when valid
+ *
+ * @param layer the calendar layer
+ * @param ctx   the graphics context to draw to
+ */
+static void draw_calendar(Layer* layer, GContext* ctx) {
+    profile_begin(PHASE_UPDATE_PROC);
+    
+    // If cached, blit cached calendar
+    // Else draw the calendar over a blank background, then cache it
+    GRect bounds = layer_get_bounds(layer);
+    if (calendar_cache_valid) {
+        graphics_draw_bitmap_in_rect(ctx, calendar_cache, bounds);
+    } else {
+        graphics_context_set_fill_color(ctx, GColorBlack);
+        graphics_fill_rect(ctx, bounds, 0, GCornerNone);
+        draw_calendar_grid(ctx, bounds);
+        calendar_cache_valid = capture_cache(ctx, layer_get_frame(layer), calendar_cache);
+    }
+    
+    profile_end(PHASE_UPDATE_PROC);
+}
+
+/**
+ * Draws the weekday header and a cell per day of the current month,
+ * today filled
+ *
+ * @param ctx    the graphics context to draw to
+ * @param bounds the bounds of the calendar layer
+ */
+static void draw_calendar_grid(GContext* ctx, GRect bounds) {
+    // Center grid in the layer
+    int left = (bounds.size.w - DAYS_PER_WEEK * CALENDAR_CELL_SIZE) / 2;
+    int top = (bounds.size.h - CALENDAR_HEADER_HEIGHT - CALENDAR_MAX_WEEKS * CALENDAR_CELL_SIZE) / 2;
+    GFont font = fonts_get_system_font(FONT_KEY_GOTHIC_14);
+    
+    // Draw weekday header
+    graphics_context_set_text_color(ctx, GColorGreen);
+    for (int wday = 0; wday < DAYS_PER_WEEK; wday++) {
+        graphics_draw_text(ctx, WEEKDAY_INITIALS[wday], font,
+                           GRect(left + wday * CALENDAR_CELL_SIZE, top, CALENDAR_CELL_SIZE, CALENDAR_HEADER_HEIGHT),
+                           GTextOverflowModeFill, GTextAlignmentCenter, NULL);
+    }
+    top += CALENDAR_HEADER_HEIGHT;
+    
+    // Get the weekday of the first of the month
+    int first_wday = (civil_time.tm_wday + DAYS_PER_WEEK - (civil_time.tm_mday - 1) % DAYS_PER_WEEK) % DAYS_PER_WEEK;
+    
+    // Draw a cell per day, filling today's
+    char label[3];
+    int days = civil_time_days_in_month();
+    for (int mday = 1; mday <= days; mday++) {
+        int slot = first_wday + mday - 1;
+        GRect cell = GRect(left + (slot % DAYS_PER_WEEK) * CALENDAR_CELL_SIZE,
+                           top + (slot / DAYS_PER_WEEK) * CALENDAR_CELL_SIZE,
+                           CALENDAR_CELL_SIZE - 1, CALENDAR_CELL_SIZE - 1);
+        if (mday == civil_time.tm_mday) {
+            graphics_context_set_fill_color(ctx, GColorGreen);
+            graphics_fill_rect(ctx, cell, 0, GCornerNone);
+            graphics_context_set_text_color(ctx, GColorBlack);
+        } else {
+            graphics_context_set_text_color(ctx, GColorGreen);
+        }
+        snprintf(label, sizeof(label), "%d", mday);
+        graphics_draw_text(ctx, label, font, cell, GTextOverflowModeFill, GTextAlignmentCenter, NULL);
+    }
+}
+
+/**
+ * Draws the cells of the given field
+ *
+ * @param ctx             the graphics context to draw to
+ * @param field           the field to draw
+ * @param font            the font to draw the glyphs with
+ * @param slide_direction 1 if animating bits slide down, -1 if they slide up
+ */
+static void draw_binary_cells(GContext* ctx, const BinaryField* field, GFont font, int slide_direction) {
+    // Draw the glyph of each cell of the field
+    graphics_context_set_text_color(ctx, GColorGreen);
+    for (int i = field->first_cell; i < field->first_cell + field->width; i++) {
+        GRect cell = GRect(cell_x[i], cell_y[i], cell_w[i], cell_h[i]);
+        int value = cell_state[i];
+        
+        // If the bit is animating, slide the old glyph out
+        // while the new glyph slides in behind it (the layer clips both)
+        // Else draw the glyph in place
+        if (bit_animation && ((field->flipped >> cell_bit[i]) & 1)) {
+            GRect slide = cell;
+            slide.origin.y += slide_direction * cell.size.h * bit_animation_frame / BIT_ANIMATION_MAX_FRAMES;
+            graphics_draw_text(ctx, BIT_GLYPHS[!value], font, slide,
+                               GTextOverflowModeFill, GTextAlignmentLeft, NULL);
+            slide.origin.y -= slide_direction * cell.size.h;
+            graphics_draw_text(ctx, BIT_GLYPHS[value], font, slide,
+                               GTextOverflowModeFill, GTextAlignmentLeft, NULL);
+        } else {
+            graphics_draw_text(ctx, BIT_GLYPHS[value], font, cell,
+                               GTextOverflowModeFill, GTextAlignmentLeft, NULL);
+        }
+    }
+}
+
+/**
+ * Appends the cells of the given field to the cell arrays
+ *
+ * @param index   the index of the field
+ * @param origin  the top left of the field within its layer
+ * @param metrics the metrics of the font of the field
+ */
+static void add_field_cells(FieldIndex index, GPoint origin, const FontMetrics* metrics) {
+    // Field cells start at the next free cell
+    BinaryField* field = FIELDS[index];
+    field->first_cell = cell_count;
+    
+    // Add one cell per bit, most significant bit first
+    for (int bit = field->width - 1; bit >= 0; bit--) {
+        cell_x[cell_count] = origin.x + (field->width - 1 - bit) * metrics->cell_width;
+        cell_y[cell_count] = origin.y;
+        cell_w[cell_count] = metrics->cell_width;
+        cell_h[cell_count] = metrics->row_height;
+        cell_field[cell_count] = index;
+        cell_bit[cell_count] = bit;
+        cell_state[cell_count] = (field->value >> bit) & 1;
+        cell_count++;
+    }
+}
+
+/**
+ * Toggles the state of every cell whose bit flipped in the last update
+ */
+static void update_cell_states(void) {
+    for (int i = 0; i < CELL_COUNT; i++) {
+        uint8_t flipped = (FIELDS[cell_field[i]]->flipped >> cell_bit[i]) & 1;
+        cell_state[i] ^= flipped;
+        perf_hour.bit_flips += flipped;
+    }
+}
+
+//--------------------------CACHE BITMAPS--------------------------
+
+/**
+ * Creates a blank two color cache bitmap, 1 bit per pixel
+ *
+ * @param size the size of the bitmap
+ *
+ * @return the created bitmap
+ */
+static GBitmap* cache_bitmap_create(GSize size) {
+#if defined(PBL_COLOR)
+    // Palettized, expanded to the frame buffer format when drawn
+    cache_palette[0] = GColorBlack;
+    cache_palette[1] = GColorGreen;
+    return gbitmap_create_blank_with_palette(size, GBitmapFormat1BitPalette, cache_palette, false);
+#else
+    // Already the frame buffer format
+    return gbitmap_create_blank(size, GBitmapFormat1Bit);
+#endif
+}
+
+/**
+ * Returns true if the pixel at the given visible x of a frame buffer
+ * row is not the background color
+ *
+ * @param row the row of the frame buffer
+ * @param x   the x of the pixel, within the visible span of the row
+ *
+ * @return true if the pixel is lit
+ */
+static bool frame_buffer_pixel_lit(GBitmapDataRowInfo row, int x) {
+#if defined(PBL_COLOR)
+    // One byte per pixel
+    return row.data[x] != GColorBlack.argb;
+#else
+    // One bit per pixel, least significant bit first
+    return (row.data[x / 8] >> (x % 8)) & 1;
+#endif
+}
+
+/**
+ * Sets the pixel at the given x of a cache bitmap row
+ *
+ * @param row the data of the row of the cache bitmap
+ * @param x   the x of the pixel
+ * @param lit true to set the pixel to the foreground color, false for background
+ */
+static void cache_row_set_pixel(uint8_t* row, int x, bool lit) {
+    // Palettized bitmaps are packed most significant bit first,
+    // 1 bit bitmaps least significant bit first
+    uint8_t mask = PBL_IF_COLOR_ELSE(0x80 >> (x % 8), 1 << (x % 8));
+    
+    // Set or clear bit
+    if (lit) {
+        row[x / 8] |= mask;
+    } else {
+        row[x / 8] &= ~mask;
+    }
+}
+
+/**
+ * Copies the pixels drawn in the given frame into the given cache bitmap
+ *
+ * @param ctx   the graphics context drawn to
+ * @param frame the frame of the cached layer on screen
+ * @param cache the cache bitmap, the size of the frame
+ *
+ * @return true if copied, false if the frame buffer was busy
+ */
+static bool capture_cache(GContext* ctx, GRect frame, GBitmap* cache) {
+    // Get frame buffer, try again next draw if busy
+    GBitmap* frame_buffer = graphics_capture_frame_buffer(ctx);
+    if (!frame_buffer) {
+        return false;
+    }
+    
+    // Copy each row of the frame into the cache
+    uint16_t cache_bytes_per_row = gbitmap_get_bytes_per_row(cache);
+    for (int y = 0; y < frame.size.h; y++) {
+        int screen_y = frame.origin.y + y;
+        GBitmapDataRowInfo source = gbitmap_get_data_row_info(frame_buffer, screen_y);
+        GBitmapDataRowInfo cache_row = gbitmap_get_data_row_info(cache, y);
+        
+        // Clear the cache row to background
+        memset(cache_row.data, 0, cache_bytes_per_row);
+        
+        // Clip the frame to the visible span of the row
+        // (the row info already excludes the corners of a round display)
+        int start = source.min_x;
+        int end = source.max_x + 1;
+        if (start < frame.origin.x) {
+            start = frame.origin.x;
+        }
+        if (end > frame.origin.x + frame.size.w) {
+            end = frame.origin.x + frame.size.w;
+        }
+        
+        // Copy only the lit pixels of the visible span
+        for (int x = start; x < end; x++) {
+            if (frame_buffer_pixel_lit(source, x)) {
+                cache_row_set_pixel(cache_row.data, x - frame.origin.x, true);
+            }
+        }
+    }
+    
+    // Release frame buffer
+    graphics_release_frame_buffer(ctx, frame_buffer);
+    return true;
+}
+
+
+
+//--------------------------BIT ANIMATION--------------------------
+
+/**
+ * The implementation of the bit animation
+ */
+static const AnimationImplementation BIT_ANIMATION_IMPLEMENTATION = {
+    .update = on_bit_animation_update
+};
+
+/**
+ * Starts animating the bits flipped by the last display_time, if allowed
+ */
+static void start_bit_animation(void) {
+    // Return if an animation is still running, it picks up the new flips
+    // (unscheduling it would run its stopped handler, which allocates
+    // the next animation, inside the tick path)
+    if (bit_animation) {
+        return;
+    }
+    
+    // Return if nothing flipped or animating is not allowed
+    if (!(hour_field.flipped | minute_field.flipped | month_field.flipped | day_field.flipped)
+     || !bit_animation_allowed()) {
+        return;
+    }
+    
+    // Return if no animation is prepared
+    if (!bit_animation_prepared) {
+        return;
+    }
+    
+    // Schedule prepared animation
+    // (it is destroyed automatically when it stops)
+    bit_animation_frame = 0;
+    bit_animation = bit_animation_prepared;
+    bit_animation_prepared = NULL;
+    animation_schedule(bit_animation);
+}
+
+/**
+ * Creates the next bit animation, if not already prepared
+ */
+static void prepare_bit_animation(void) {
+    // Return if already prepared
+    if (bit_animation_prepared) {
+        return;
+    }
+    
+    // Create and configure animation
+    bit_animation_prepared = animation_create();
+    animation_set_duration(bit_animation_prepared, BIT_ANIMATION_DURATION_MS);
+    animation_set_curve(bit_animation_prepared, AnimationCurveEaseOut);
+    animation_set_implementation(bit_animation_prepared, &BIT_ANIMATION_IMPLEMENTATION);
+    animation_set_handlers(bit_animation_prepared, (AnimationHandlers) {
+        .stopped = on_bit_animation_stopped
+    }, NULL);
+}
+
+/**
+ * Returns true if bit flips may be animated right now
+ *
+ * @return false if the governor has dropped animations or the calendar covers the face
+ */
+static bool bit_animation_allowed(void) {
+    return governor_allows(GOVERNOR_NO_ANIMATION)
+        && !(CALENDAR_ENABLED && !layer_get_hidden(calendar_layer));
+}
+
+/**
+ * Called on every step of the bit animation
+ *
+ * @param animation the bit animation
+ * @param progress  the progress of the animation
+ */
+static void on_bit_animation_update(Animation* animation, const AnimationProgress progress) {
+    // Quantize progress to frames so redraws are capped
+    // no matter how often the animation steps
+    int frame = progress * BIT_ANIMATION_MAX_FRAMES / ANIMATION_NORMALIZED_MAX;
+    
+    // Redraw only if the frame changed
+    if (frame != bit_animation_frame) {
+        profile_begin(PHASE_ANIMATION_FRAME);
+        bit_animation_frame = frame;
+        mark_flipped_layers_dirty();
+        profile_end(PHASE_ANIMATION_FRAME);
+    }
+}
+
+/**
+ * Called when the bit animation is stopped
+ *
+ * @param animation the bit animation
+ * @param finished  true if the animation ran to completion
+ * @param context   unused
+ */
+static void on_bit_animation_stopped(Animation* animation, bool finished, void* context) {
+    // Forget animation and draw final state
+    bit_animation = NULL;
+    mark_flipped_layers_dirty();
+    
+    // Replace the animation outside of the tick path
+    prepare_bit_animation();
+}
+
+/**
+ * Marks the layers of all fields with flipped bits dirty
+ */
+static void mark_flipped_layers_dirty(void) {
+    if (hour_field.flipped) {
+        layer_mark_dirty(hour_layer);
+    }
+    if (minute_field.flipped) {
+        layer_mark_dirty(minute_layer);
+    }
+    if (month_field.flipped | day_field.flipped) {
+        layer_mark_dirty(date_layer);
+    }
+}
+
+
+
+//--------------------------DECIMAL OVERLAY--------------------------
+
+/**
+ * Shows the decimal overlay, refreshing its text if stale
+ *
+ * @param duration_ms how long to show the overlay in milliseconds
+ */
+static void show_decimal_overlay(uint32_t duration_ms) {
+    // Format text only if the minute changed since it was last shown
+    if (decimal_overlay_stale) {
+        format_decimal_overlay();
+    }
+    
+    // Show overlay
+    layer_set_hidden(text_layer_get_layer(decimal_overlay_layer), false);
+    
+    // Hide overlay after the duration, extending it if already shown
+    if (decimal_overlay_timer) {
+        app_timer_reschedule(decimal_overlay_timer, duration_ms);
+    } else {
+        decimal_overlay_timer = app_timer_register(duration_ms, on_decimal_overlay_timeout, NULL);
+    }
+}
+
+/**
+ * Called when the decimal overlay should be hidden
+ *
+ * @param context unused
+ */
+static void on_decimal_overlay_timeout(void* context) {
+    decimal_overlay_timer = NULL;
+    layer_set_hidden(text_layer_get_layer(decimal_overlay_layer), true);
+}
+
+/**
+ * Fills the decimal overlay buffer with the displayed time and date
+ */
+static void format_decimal_overlay(void) {
+    // Print time and date
+    snprintf(decimal_overlay_buffer, sizeof(decimal_overlay_buffer), "%02d:%02d\n%02d/%02d",
+             tm_get_hours(&civil_time), civil_time.tm_min, tm_get_months(&civil_time), civil_time.tm_mday);
+    decimal_overlay_stale = false;
+    
+    // Redraw overlay with new text
+    profile_begin(PHASE_SET_TEXT);
+    text_layer_set_text(decimal_overlay_layer, decimal_overlay_buffer);
+    profile_end(PHASE_SET_TEXT);
+}
+
+
+
+//--------------------------CALENDAR--------------------------
+
+/**
+ * Shows the calendar if hidden, else hides it
+ */
+static void toggle_calendar(void) {
+    bool show = layer_get_hidden(calendar_layer);
+    
+    // Return if down to the minimal face, which has no calendar
+    if (show && !governor_allows(GOVERNOR_MINIMAL)) {
+        return;
+    }
+    
+    // Hide the overlay the first flick brought up
+    if (show && decimal_overlay_timer) {
+        app_timer_cancel(decimal_overlay_timer);
+        on_decimal_overlay_timeout(NULL);
+    }
+    
+    // Show or hide calendar, drawn from the cache if still valid
+    layer_set_hidden(calendar_layer, !show);
+}
+
+
+
+//--------------------------HEAP CHECK--------------------------
+
+/**
+ * Warns if the heap grew since the window loaded
+ */
+static void check_heap(void) {
+    // Skip while a timer or sampling window holds a transient allocation
+    if (decimal_overlay_timer || gesture_sampling) {
+        return;
+    }
+    
+    // Warn once per growth
+    size_t used = heap_bytes_used();
+    if (used > heap_baseline) {
+        APP_LOG(APP_LOG_LEVEL_WARNING, "Heap grew by %d bytes since load", (int)(used - heap_baseline));
+        heap_baseline = used;
+    }
+}
+
+
+
+//--------------------------PERF BUDGETS--------------------------
+
+/**
+ * Records the heap used right now in the hour's peak
+ */
+static void perf_sample_heap(void) {
+    uint32_t used = heap_bytes_used();
+    if (used > perf_hour.heap_peak_bytes) {
+        perf_hour.heap_peak_bytes = used;
+    }
+}
+
+/**
+ * Sends the hour's counters as telemetry and folds them into the day's
+ */
+static void perf_end_hour(void) {
+    // Send hour
+    if (TELEMETRY_ENABLED) {
+        telemetry_log_hour();
+    }
+    
+    // Sum counts into the day
+    perf_today.ticks += perf_hour.ticks;
+    perf_today.draws += perf_hour.draws;
+    perf_today.bit_flips += perf_hour.bit_flips;
+    perf_today.saved_ticks += perf_hour.saved_ticks;
+    
+    // Keep the worst of the day
+    if (perf_hour.worst_latency_ms > perf_today.worst_latency_ms) {
+        perf_today.worst_latency_ms = perf_hour.worst_latency_ms;
+    }
+    if (perf_hour.heap_peak_bytes > perf_today.heap_peak_bytes) {
+        perf_today.heap_peak_bytes = perf_hour.heap_peak_bytes;
+    }
+    
+    // Clear hour
+    memset(&perf_hour, 0, sizeof(perf_hour));
+    memset(&update_latency_histogram, 0, sizeof(update_latency_histogram));
+    memset(&tick_jitter_histogram, 0, sizeof(tick_jitter_histogram));
+}
+
+/**
+ * Warns about each daily counter over its budget or baseline, storing
+ * the baseline if there is none yet, then clears the counters
+ */
+static void perf_check_budgets(void) {
+    // Check the counters whose budgets follow from the face itself
+    perf_check_budget("Draws", perf_today.draws, PERF_BUDGET_DRAWS_PER_DAY);
+    perf_check_budget("Bit flips", perf_today.bit_flips, PERF_BUDGET_BIT_FLIPS_PER_DAY);
+    
+    // Check the measured counters against the stored baseline,
+    // or store this day's as the baseline if it covered the whole day
+    PerfBaseline baseline;
+    if (persist_read_data(PERSIST_KEY_PERF_BASELINE, &baseline, sizeof(baseline)) == sizeof(baseline)) {
+        perf_check_budget("Worst latency ms", perf_today.worst_latency_ms, baseline.worst_latency_ms);
+        perf_check_budget("Heap peak bytes", perf_today.heap_peak_bytes, baseline.heap_peak_bytes);
+    } else if (perf_full_day) {
+        baseline.worst_latency_ms = perf_today.worst_latency_ms;
+        baseline.heap_peak_bytes = perf_today.heap_peak_bytes;
+        persist_write_data(PERSIST_KEY_PERF_BASELINE, &baseline, sizeof(baseline));
+        APP_LOG(APP_LOG_LEVEL_INFO, "Stored baseline: worst latency %lu ms, heap peak %lu bytes",
+                (unsigned long)baseline.worst_latency_ms, (unsigned long)baseline.heap_peak_bytes);
+    }
+    
+    // Clear counters, the next day is a whole one
+    memset(&perf_today, 0, sizeof(perf_today));
+    perf_full_day = true;
+}
+
+/**
+ * Warns if the given counter is over its budget by more than the threshold
+ *
+ * @param name   the name of the counter
+ * @param value  the value of the counter
+ * @param budget the budget of the counter
+ */
+static void perf_check_budget(const char* name, uint32_t value, uint32_t budget) {
+    if (value * 100 > budget * (100 + PERF_REGRESSION_THRESHOLD_PERCENT)) {
+        APP_LOG(APP_LOG_LEVEL_WARNING, "Over budget: %s %lu > %lu",
+                name, (unsigned long)value, (unsigned long)budget);
+    }
+}
+
+
+
+//--------------------------PROFILER--------------------------
+
+/**
+ * Returns the current time in milliseconds since the epoch
+ *
+ * @return the current time in milliseconds
+ */
+static int64_t profiler_now_ms(void) {
+    time_t seconds;
+    uint16_t ms;
+    time_ms(&seconds, &ms);
+    return (int64_t)seconds * 1000 + ms;
+}
+
+/**
+ * Records the tick jitter and starts timing the update latency
+ */
+static void profile_tick(void) {
+    int64_t now = profiler_now_ms();
+    
+    // Record how far the gap since the last tick is from a minute
+    if (last_tick_ms) {
+        int64_t jitter = now - last_tick_ms - MS_PER_MINUTE;
+        histogram_add(&tick_jitter_histogram, jitter < 0 ? -jitter : jitter);
+    }
+    last_tick_ms = now;
+    
+    // Start timing from the minute boundary this tick is for
+    pending_minute_ms = now - now % MS_PER_MINUTE;
+}
+
+/**
+ * Records the update latency if the minute being drawn is pending
+ */
+static void profile_minute_drawn(void) {
+    if (pending_minute_ms) {
+        // Add to histogram
+        int64_t latency = profiler_now_ms() - pending_minute_ms;
+        histogram_add(&update_latency_histogram, latency);
+        pending_minute_ms = 0;
+        
+        // Keep the worst of the hour
+        if (latency > perf_hour.worst_latency_ms) {
+            perf_hour.worst_latency_ms = latency;
+        }
+    }
+}
+
+/**
+ * Adds a sample to the given histogram
+ *
+ * @param histogram the histogram to add to
+ * @param ms        the sample in milliseconds
+ */
+static void histogram_add(Histogram* histogram, int64_t ms) {
+    // Find the first bucket the sample fits in, else the last
+    int bucket = 0;
+    while (bucket < PROFILER_BUCKET_COUNT - 1 && ms > PROFILER_BUCKET_LIMITS_MS[bucket]) {
+        bucket++;
+    }
+    
+    // Count sample, saturating
+    if (histogram->counts[bucket] < UINT16_MAX) {
+        histogram->counts[bucket]++;
+    }
+}
+
+
+
+//--------------------------TELEMETRY--------------------------
+
+/**
+ * Sends the hour's counters and histograms as one telemetry record
+ */
+static void telemetry_log_hour(void) {
+    // Fill record with the hour that just ended
+    time_t now = time(NULL);
+    TelemetryRecord record = {
+        .hour_start = now - now % SECONDS_PER_HOUR - SECONDS_PER_HOUR,
+        .ticks = saturate_u16(perf_hour.ticks),
+        .draws = saturate_u16(perf_hour.draws),
+        .bit_flips = saturate_u16(perf_hour.bit_flips),
+        .worst_latency_ms = saturate_u16(perf_hour.worst_latency_ms),
+        .heap_peak_bytes = saturate_u16(perf_hour.heap_peak_bytes),
+        .saved_ticks = saturate_u16(perf_hour.saved_ticks)
+    };
+    memcpy(record.update_latency_counts, update_latency_histogram.counts, sizeof(record.update_latency_counts));
+    memcpy(record.tick_jitter_counts, tick_jitter_histogram.counts, sizeof(record.tick_jitter_counts));
+    
+    // Queue record, the system sends queued records in batches
+    data_logging_log(telemetry_session, &record, 1);
+}
+
+/**
+ * Returns the given value, clamped to fit in 16 bits
+ *
+ * @param value the value to clamp
+ *
+ * @return the clamped value
+ */
+static uint16_t saturate_u16(uint32_t value) {
+    return value > UINT16_MAX ? UINT16_MAX : value;
+}
+
+
+
+//--------------------------TRACE EVENTS--------------------------
+
+/**
+ * Marks the beginning of the given phase
+ *
+ * @param phase the phase beginning
+ */
+static void profile_begin(ProfilePhase phase) {
+    if (TRACE_EVENTS_ENABLED) {
+        trace_event_add(phase, 'B');
+    }
+}
+
+/**
+ * Marks the end of the given phase
+ *
+ * @param phase the phase ending
+ */
+static void profile_end(ProfilePhase phase) {
+    if (TRACE_EVENTS_ENABLED) {
+        trace_event_add(phase, 'E');
+    }
+}
+
+/**
+ * Adds a trace event, logging the held events first if full
+ *
+ * @param phase the phase of the event
+ * @param type  'B' for begin, 'E' for end
+ */
+static void trace_event_add(ProfilePhase phase, char type) {
+    // Make room if full
+    if (trace_event_count == TRACE_EVENT_COUNT) {
+        trace_events_flush();
+    }
+    
+    // Stamp relative to the first event
+    int64_t now = profiler_now_ms();
+    if (!trace_events_epoch_ms) {
+        trace_events_epoch_ms = now;
+    }
+    
+    // Add event
+    trace_events[trace_event_count++] = (TraceEvent) {
+        .time_ms = now - trace_events_epoch_ms,
+        .phase = phase,
+        .type = type
+    };
+}
+
+/**
+ * Logs the held trace events as Chrome trace event JSON and clears them
+ */
+static void trace_events_flush(void) {
+    // Log one event object per line (timestamps in microseconds),
+    // to be joined into a JSON array from the log
+    for (int i = 0; i < trace_event_count; i++) {
+        APP_LOG(APP_LOG_LEVEL_DEBUG, "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu000,\"pid\":1,\"tid\":1},",
+                PHASE_NAMES[trace_events[i].phase], trace_events[i].type,
+                (unsigned long)trace_events[i].time_ms);
+    }
+    
+    // Clear events
+    trace_event_count = 0;
+}
+
+
+
+//--------------------------TRACE CAPTURE--------------------------
+
+/**
+ * Records a tick and the state it was handled in
+ *
+ * @param tick_time     the time of the tick
+ * @param units_changed the units changed by the tick
+ */
+static void trace_tick(struct tm* tick_time, TimeUnits units_changed) {
+    // Battery, quiet time and sleep decide what the tick does, so record them too
+    BatteryChargeState battery = battery_state_service_peek();
+    uint8_t flags = (battery.is_charging ? TRACE_FLAG_CHARGING : 0)
+                  | (quiet_time_is_active() ? TRACE_FLAG_QUIET_TIME : 0)
+                  | (sleep_active() ? TRACE_FLAG_ASLEEP : 0)
+                  | (sleep_suppressed ? TRACE_FLAG_SLEEP_SUPPRESSED : 0);
+    
+    // Append record
+    uint8_t record[] = {
+        TRACE_TICK,
+        tick_time->tm_min, tick_time->tm_hour, tick_time->tm_mday, tick_time->tm_mon,
+        tick_time->tm_year, tick_time->tm_wday, tick_time->tm_isdst,
+        units_changed, battery.charge_percent, flags
+    };
+    trace_append(record, sizeof(record));
+}
+
+/**
+ * Records a tap
+ *
+ * @param axis      the axis of the tap
+ * @param direction the direction of the tap
+ */
+static void trace_tap(AccelAxisType axis, int32_t direction) {
+    // Record the second of the tap to order it within its minute
+    time_t now = time(NULL);
+    uint8_t record[] = { TRACE_TAP, axis, (int8_t)direction, localtime(&now)->tm_sec };
+    trace_append(record, sizeof(record));
+}
+
+/**
+ * Records the outcome of a hold detection window
+ *
+ * @param held true if a hold was detected
+ */
+static void trace_hold(bool held) {
+    uint8_t record[] = { TRACE_HOLD, held };
+    trace_append(record, sizeof(record));
+}
+
+/**
+ * Records a health update and the sleep state peeked for it
+ *
+ * @param event the kind of update
+ */
+static void trace_health(uint8_t event) {
+    time_t now = time(NULL);
+    uint8_t record[] = { TRACE_HEALTH, event, sleep_active(), localtime(&now)->tm_sec };
+    trace_append(record, sizeof(record));
+}
+
+/**
+ * Records a value of a message received from the phone
+ *
+ * @param key    the key of the value
+ * @param data   the bytes of the value
+ * @param length the number of bytes, of which up to TRACE_MESSAGE_MAX_BYTES are kept
+ */
+static void trace_message(uint8_t key, const uint8_t* data, size_t length) {
+    // Clip value
+    if (length > TRACE_MESSAGE_MAX_BYTES) {
+        length = TRACE_MESSAGE_MAX_BYTES;
+    }
+    
+    // Append record
+    time_t now = time(NULL);
+    uint8_t record[4 + TRACE_MESSAGE_MAX_BYTES] = { TRACE_MESSAGE, key, localtime(&now)->tm_sec, length };
+    memcpy(record + 4, data, length);
+    trace_append(record, 4 + length);
+}
+
+/**
+ * Records a wakeup, fired while running or having launched the face
+ *
+ * @param cookie the cookie the wakeup was scheduled with
+ */
+static void trace_wakeup(int32_t cookie) {
+    time_t now = time(NULL);
+    uint8_t record[] = { TRACE_WAKEUP, cookie, localtime(&now)->tm_sec };
+    trace_append(record, sizeof(record));
+}
+
+/**
+ * Appends a record to the trace, dumping the trace first if full
+ *
+ * @param record the bytes of the record
+ * @param length the number of bytes in the record
+ */
+static void trace_append(const uint8_t* record, size_t length) {
+    // Start the trace with its version
+    if (!trace_started) {
+        trace_started = true;
+        trace_buffer[trace_length++] = TRACE_START;
+        trace_buffer[trace_length++] = TRACE_VERSION;
+    }
+    
+    // Make room if full
+    if (trace_length + length > sizeof(trace_buffer)) {
+        trace_flush();
+    }
+    
+    // Copy record
+    memcpy(trace_buffer + trace_length, record, length);
+    trace_length += length;
+}
+
+/**
+ * Dumps the trace to the log as hex and empties it
+ */
+static void trace_flush(void) {
+    // Log trace a line at a time
+    for (size_t start = 0; start < trace_length; start += TRACE_LOG_LINE_BYTES) {
+        // Hex encode the bytes of the line
+        size_t end = start + TRACE_LOG_LINE_BYTES < trace_length ? start + TRACE_LOG_LINE_BYTES : trace_length;
+        for (size_t i = start; i < end; i++) {
+            snprintf(trace_log_buffer + 2 * (i - start), 3, "%02x", trace_buffer[i]);
+        }
+        
+        // Log line
+        APP_LOG(APP_LOG_LEVEL_DEBUG, "TRACE %s", trace_log_buffer);
+    }
+    
+    // Empty trace
+    trace_length = 0;
+}
+
+
+
+//--------------------------DEBUG FUNCTION--------------------------
+
+/**
+ * Logs decimal and binary representations of time to console
+ *
+ * @param tick_time the time being displayed
+ */
+static void debug_time(struct tm* tick_time) {
+    // Fill binary buffers with binaries of the time and date values
+    FORMAT_AS_BINARY(HOUR_BINARY_LENGTH, hour_binary_buffer, hour_field.value);
+    FORMAT_AS_BINARY(MINUTE_BINARY_LENGTH, minute_binary_buffer, minute_field.value);
+    FORMAT_AS_BINARY(MONTH_BINARY_LENGTH, month_binary_buffer, month_field.value);
+    FORMAT_AS_BINARY(DAY_BINARY_LENGTH, day_binary_buffer, day_field.value);
+    
+    // Prints hour and minute values to buffers
+    snprintf(hour_debug_buffer, sizeof(hour_debug_buffer), "Hours %i --> %s", tm_get_hours(tick_time), hour_binary_buffer);
+    snprintf(minute_debug_buffer, sizeof(minute_debug_buffer), "Minutes %i --> %s", tick_time->tm_min, minute_binary_buffer);
+    snprintf(month_debug_buffer, sizeof(month_debug_buffer), "Month %i --> %s", tm_get_months(tick_time), month_binary_buffer);
+    snprintf(day_debug_buffer, sizeof(day_debug_buffer), "Day %i --> %s", tick_time->tm_mday, day_binary_buffer);
+    
+    // Log values to console
+    APP_LOG(APP_LOG_LEVEL_INFO, "%s", hour_debug_buffer);
+    APP_LOG(APP_LOG_LEVEL_INFO, "%s", minute_debug_buffer);
+    APP_LOG(APP_LOG_LEVEL_INFO, "%s", month_debug_buffer);
+    APP_LOG(APP_LOG_LEVEL_INFO, "%s", day_debug_buffer);
+}
+
+
+
+//--------------------------GOVERNOR--------------------------
+
+/**
+ * Returns true if the feature dropped at the given level is still allowed
+ *
+ * @param level the level the feature is dropped at
+ *
+ * @return true if the governor is below the given level
+ */
+static bool governor_allows(GovernorLevel level) {
+    return governor_level < level;
+}
+
+/**
+ * Returns the level the current battery and quiet time call for
+ *
+ * @return the level called for
+ */
+static GovernorLevel governor_target_level(void) {
+    // Get battery state
+    BatteryChargeState battery = battery_state_service_peek();
+    
+    // Levels already reached hold until the battery
+    // is clear of their threshold by the hysteresis
+    GovernorLevel target = GOVERNOR_FULL;
+    if (!battery.is_charging) {
+        static const uint8_t THRESHOLDS[] = {
+            [GOVERNOR_NO_ANIMATION] = BIT_ANIMATION_MIN_BATTERY_PERCENT,
+            [GOVERNOR_NO_HOLD] = GOVERNOR_NO_HOLD_BATTERY_PERCENT,
+            [GOVERNOR_MINIMAL] = GOVERNOR_MINIMAL_BATTERY_PERCENT
+        };
+        for (GovernorLevel level = GOVERNOR_NO_ANIMATION; level <= GOVERNOR_MINIMAL; level++) {
+            int threshold = THRESHOLDS[level]
+                          + (level <= governor_level ? GOVERNOR_BATTERY_HYSTERESIS_PERCENT : 0);
+            if (battery.charge_percent <= threshold) {
+                target = level;
+            }
+        }
+    }
+    
+    // Nothing moves in quiet time
+    if (quiet_time_is_active() && target < GOVERNOR_NO_ANIMATION) {
+        target = GOVERNOR_NO_ANIMATION;
+    }
+    
+    return target;
+}
+
+/**
+ * Steps the governor after a tick, dropping features at once
+ * and restoring them one at a time once things are calm
+ *
+ * @param tick_cost_ms how long the tick took in milliseconds
+ */
+static void governor_update(int64_t tick_cost_ms) {
+    // Get level called for, one past the current if the tick ran long
+    GovernorLevel target = governor_target_level();
+    if (tick_cost_ms > GOVERNOR_TICK_BUDGET_MS && governor_level < GOVERNOR_MINIMAL
+     && target <= governor_level) {
+        target = governor_level + 1;
+    }
+    
+    // Drop at once
+    if (target > governor_level) {
+        governor_calm_ticks = 0;
+        governor_set_level(target);
+    }
+    
+    // Restore one level after enough calm ticks
+    else if (target < governor_level) {
+        if (++governor_calm_ticks >= GOVERNOR_RESTORE_TICKS) {
+            governor_calm_ticks = 0;
+            governor_set_level(governor_level - 1);
+        }
+    }
+    
+    // Hold
+    else {
+        governor_calm_ticks = 0;
+    }
+}
+
+/**
+ * Sets the governor level
+ *
+ * @param level the new level
+ */
+static void governor_set_level(GovernorLevel level) {
+    APP_LOG(APP_LOG_LEVEL_INFO, "Governor level %d -> %d", governor_level, level);
+    governor_level = level;
+    
+    // Hide progress rows on the minimal face, catching them up when shown again
+    if (PROGRESS_ROWS_ENABLED) {
+        layer_set_hidden(progress_layer, !governor_allows(GOVERNOR_MINIMAL));
+        if (governor_allows(GOVERNOR_MINIMAL)) {
+            progress_step(&civil_time);
+        }
+    }
+    
+    // Hide weather rows on the minimal face, the last weather stays known
+    if (WEATHER_ENABLED && weather_known) {
+        layer_set_hidden(weather_layer, !governor_allows(GOVERNOR_MINIMAL));
+    }
+    
+    // Close calendar on the minimal face
+    if (CALENDAR_ENABLED && !governor_allows(GOVERNOR_MINIMAL)) {
+        layer_set_hidden(calendar_layer, true);
+    }
+}
+
+
+
+//--------------------------SLEEP SUPPRESSION--------------------------
+
+/**
+ * Returns true if the wearer is asleep
+ *
+ * @return true if health tracking reports sleep
+ */
+static bool sleep_active(void) {
+#if defined(PBL_HEALTH)
+    return health_service_peek_current_activities() & (HealthActivitySleep | HealthActivityRestfulSleep);
+#else
+    return false;
+#endif
+}
+
+/**
+ * Suppresses or resumes minute ticks to match the wearer being asleep
+ */
+static void sleep_update(void) {
+    bool sleeping = sleep_active();
+    
+    // Fell asleep, tick hourly
+    if (sleeping && !sleep_suppressed) {
+        sleep_suppressed = true;
+        sleep_last_wakeup = time(NULL);
+        tick_timer_service_subscribe(HOUR_UNIT, on_tick);
+    }
+    
+    // Woke up, tick every minute again
+    else if (!sleeping && sleep_suppressed) {
+        sleep_count_saved_ticks(false);
+        sleep_suppressed = false;
+        tick_timer_service_subscribe(MINUTE_UNIT, on_tick);
+        sleep_catch_up();
+        
+        // Restart jitter from here rather than the last hourly tick
+        last_tick_ms = 0;
+    }
+}
+
+/**
+ * Catches the display up to the current time after ticks were skipped
+ */
+static void sleep_catch_up(void) {
+    // Redraw the current time once (the skipped minutes are not animated)
+    time_t now = time(NULL);
+    civil_time_sync(localtime(&now));
+    if (countdown_target) {
+        countdown_step(now);
+    }
+    display_time(&civil_time);
+    decimal_overlay_stale = true;
+}
+
+/**
+ * Counts the minute ticks skipped since the last wakeup
+ *
+ * @param ticked true if this wakeup is itself a tick
+ */
+static void sleep_count_saved_ticks(bool ticked) {
+    // Every minute boundary passed would have been a tick
+    time_t now = time(NULL);
+    int32_t minutes = now / SECONDS_PER_MINUTE - sleep_last_wakeup / SECONDS_PER_MINUTE;
+    if (ticked) {
+        minutes--;
+    }
+    if (minutes > 0) {
+        perf_hour.saved_ticks += minutes;
+    }
+    sleep_last_wakeup = now;
+}
+
+#if defined(PBL_HEALTH)
+/**
+ * Called when health tracking has an update
+ *
+ * @param event   the kind of update
+ * @param context unused
+ */
+static void on_health_event(HealthEventType event, void* context) {
+    // Record update
+    if (TRACE_CAPTURE_ENABLED) {
+        trace_health(event);
+    }
+    
+    // Suppress or resume minute ticks on sleep changes
+    if (event == HealthEventSleepUpdate || event == HealthEventSignificantUpdate) {
+        sleep_update();
+    }
+}
+#endif
+
+
+
+//--------------------------COUNTDOWN--------------------------
+
+/**
+ * Starts counting down to the given time, replacing any countdown
+ *
+ * @param target the time to count down to, or 0 to cancel
+ */
+static void countdown_set(time_t target) {
+    // Cancel the wakeup of the last countdown
+    if (countdown_target) {
+        wakeup_cancel(countdown_wakeup);
+    }
+    
+    // Clear if the target is not ahead
+    time_t now = time(NULL);
+    if (target <= now) {
+        countdown_target = 0;
+        persist_delete(PERSIST_KEY_COUNTDOWN_TARGET);
+        persist_delete(PERSIST_KEY_COUNTDOWN_WAKEUP);
+        return;
+    }
+    
+    // Wake up at the target even if the face is not running,
+    // a minute later at a time if another wakeup is that close
+    countdown_target = target;
+    countdown_wakeup = wakeup_schedule(target, COUNTDOWN_WAKEUP_COOKIE, true);
+    for (int retry = 1; countdown_wakeup == E_RANGE && retry <= COUNTDOWN_WAKEUP_RETRIES; retry++) {
+        countdown_wakeup = wakeup_schedule(target + retry * SECONDS_PER_MINUTE, COUNTDOWN_WAKEUP_COOKIE, true);
+    }
+    if (countdown_wakeup < 0) {
+        APP_LOG(APP_LOG_LEVEL_WARNING, "Countdown wakeup not scheduled: %d", (int)countdown_wakeup);
+    }
+    
+    // Save for the next run
+    persist_write_int(PERSIST_KEY_COUNTDOWN_TARGET, countdown_target);
+    persist_write_int(PERSIST_KEY_COUNTDOWN_WAKEUP, countdown_wakeup);
+    
+    countdown_sync(now / SECONDS_PER_MINUTE);
+}
+
+/**
+ * Resumes the countdown saved by the last run
+ */
+static void countdown_restore(void) {
+    // Return if no countdown saved
+    if (!persist_exists(PERSIST_KEY_COUNTDOWN_TARGET)) {
+        return;
+    }
+    
+    // Read countdown
+    countdown_target = persist_read_int(PERSIST_KEY_COUNTDOWN_TARGET);
+    countdown_wakeup = persist_read_int(PERSIST_KEY_COUNTDOWN_WAKEUP);
+    
+    // End a countdown that ran out while the face was not running,
+    // vibrating only if its wakeup is what launched the face
+    time_t now = time(NULL);
+    if (countdown_target <= now) {
+        countdown_finish(launch_reason() == APP_LAUNCH_WAKEUP);
+        return;
+    }
+    
+    // Schedule again if the wakeup was lost
+    if (!wakeup_query(countdown_wakeup, NULL)) {
+        countdown_set(countdown_target);
+        return;
+    }
+    
+    countdown_sync(now / SECONDS_PER_MINUTE);
+}
+
+/**
+ * Sets the time left from the countdown target
+ *
+ * @param minute the current minute (since the epoch)
+ */
+static void countdown_sync(int32_t minute) {
+    // Count partial minutes as whole minutes left
+    int32_t left = (countdown_target - minute * SECONDS_PER_MINUTE + SECONDS_PER_MINUTE - 1) / SECONDS_PER_MINUTE;
+    
+    // Clamp to one past what the hour field can show, which is
+    // held at its maximum and resynced every step until under it
+    if (left / MINUTES_PER_HOUR > COUNTDOWN_MAX_HOURS) {
+        countdown_hours = COUNTDOWN_MAX_HOURS + 1;
+        countdown_minutes = 0;
+    } else {
+        countdown_hours = left / MINUTES_PER_HOUR;
+        countdown_minutes = left % MINUTES_PER_HOUR;
+    }
+    countdown_last_minute = minute;
+}
+
+/**
+ * Steps the time left to the given time, by one minute if
+ * it is the minute after the last step, else by resyncing
+ * (also while the time left is clamped)
+ *
+ * @param now the current time
+ */
+static void countdown_step(time_t now) {
+    int32_t minute = now / SECONDS_PER_MINUTE;
+    
+    // Take a minute off, borrowing from the hours
+    if (minute == countdown_last_minute + 1 && (countdown_hours || countdown_minutes)
+     && countdown_hours <= COUNTDOWN_MAX_HOURS) {
+        if (countdown_minutes) {
+            countdown_minutes--;
+        } else {
+            countdown_hours--;
+            countdown_minutes = MINUTES_PER_HOUR - 1;
+        }
+        countdown_last_minute = minute;
+    }
+    
+    // Resync after a gap
+    else {
+        countdown_sync(minute);
+    }
+    
+    // End if no time left (the wakeup may not have fired yet)
+    if (!countdown_hours && !countdown_minutes) {
+        countdown_finish(true);
+    }
+}
+
+/**
+ * Ends the countdown
+ *
+ * @param alert true if the end is vibrated
+ */
+static void countdown_finish(bool alert) {
+    countdown_set(0);
+    
+    // Vibrate unless in quiet time
+    if (alert && !quiet_time_is_active()) {
+        vibes_long_pulse();
+    }
+}
+
+/**
+ * Called when a scheduled wakeup fires while the face is running
+ *
+ * @param id     the id of the wakeup
+ * @param cookie the cookie the wakeup was scheduled with
+ */
+static void on_wakeup(WakeupId id, int32_t cookie) {
+    // Record wakeup
+    if (TRACE_CAPTURE_ENABLED) {
+        trace_wakeup(cookie);
+    }
+    
+    // End countdown, unless a tick already did, and show the time again
+    if (cookie == COUNTDOWN_WAKEUP_COOKIE && countdown_target) {
+        countdown_finish(true);
+        display_time(&civil_time);
+    }
+}
+
+/**
+ * Called when a message is received from the phone
+ *
+ * @param iterator the contents of the message
+ * @param context  unused
+ */
+static void on_message_received(DictionaryIterator* iterator, void* context) {
+    // Start or cancel countdown
+    Tuple* target = dict_find(iterator, APP_KEY_COUNTDOWN_TARGET);
+    if (TRACE_CAPTURE_ENABLED && target) {
+        trace_message(APP_KEY_COUNTDOWN_TARGET, target->value->data, target->length);
+    }
+    if (COUNTDOWN_ENABLED && target) {
+        countdown_set(target->value->int32);
+        display_time(&civil_time);
+    }
+    
+    // Show weather, ignoring payloads of the wrong size
+    Tuple* payload = dict_find(iterator, APP_KEY_WEATHER);
+    if (TRACE_CAPTURE_ENABLED && payload) {
+        trace_message(APP_KEY_WEATHER, payload->value->data, payload->length);
+    }
+    if (WEATHER_ENABLED && payload && payload->length == sizeof(WeatherPayload)) {
+        weather_set((const WeatherPayload*)payload->value->data);
+    }
+}
+
+
+
+//--------------------------WEATHER--------------------------
+
+/**
+ * Shows the given weather, saving it for the next run if it changed
+ *
+ * @param payload the weather to show
+ */
+static void weather_set(const WeatherPayload* payload) {
+    // Save only if new or changed, sparing the flash
+    if (!weather_known || memcmp(&weather, payload, sizeof(weather))) {
+        persist_write_data(PERSIST_KEY_WEATHER, payload, sizeof(*payload));
+    }
+    weather_show(payload);
+}
+
+/**
+ * Shows the given weather
+ *
+ * @param payload the weather to show
+ */
+static void weather_show(const WeatherPayload* payload) {
+    weather = *payload;
+    weather_known = true;
+    
+    // Show rows, redrawing only if any bit flipped, unless on the minimal face
+    set_binary_field(&weather_fields[WEATHER_TEMPERATURE], weather_layer, (uint8_t)weather.temperature);
+    set_binary_field(&weather_fields[WEATHER_CONDITION], weather_layer, weather.condition);
+    layer_set_hidden(weather_layer, !governor_allows(GOVERNOR_MINIMAL));
+}
+
+/**
+ * Shows the weather saved by the last run
+ */
+static void weather_restore(void) {
+    WeatherPayload saved;
+    if (persist_read_data(PERSIST_KEY_WEATHER, &saved, sizeof(saved)) == sizeof(saved)) {
+        weather_show(&saved);
+    }
+}
+
+
+
+//--------------------------TICK TIMER HANDLER--------------------------
+
+/**
+ * Called on every tick
+ *
+ * @param tick_time     the current time
+ * @param units_changed the amount of time since the last tick
+ */
+static void on_tick(struct tm* tick_time, TimeUnits units_changed) {
+    profile_begin(PHASE_TICK);
+    int64_t tick_start_ms = profiler_now_ms();
+    
+    // Record tick
+    if (TRACE_CAPTURE_ENABLED) {
+        trace_tick(tick_time, units_changed);
+    }
+    
+    // Check nothing allocated since the last tick
+    if (HEAP_CHECK_ENABLED) {
+        check_heap();
+    }
+    
+    // Close out the hour, and the day, that just ended
+    if (units_changed & HOUR_UNIT) {
+        perf_end_hour();
+        if (PERF_BUDGET_ENABLED && (units_changed & DAY_UNIT)) {
+            perf_check_budgets();
+        }
+        trace_events_flush();
+    }
+    
+    // Count tick and sample heap
+    perf_hour.ticks++;
+    perf_sample_heap();
+    
+    // Count the ticks skipped while asleep
+    if (sleep_suppressed) {
+        sleep_count_saved_ticks(true);
+    }
+    
+    // Time this tick (hourly ticks while asleep are not timed)
+    if (PROFILER_ENABLED && !sleep_suppressed) {
+        profile_tick();
+    }
+    
+    // Take a minute off the countdown
+    if (countdown_target) {
+        countdown_step(time(NULL));
+    }
+    
+    display_time(civil_time_step(tick_time));
+    
+    // Animate bits that flipped
+    if (BIT_ANIMATION_ENABLED) {
+        start_bit_animation();
+    }
+    
+    // Vibrate the hour bits at the top of the hour, unless in quiet time,
+    // asleep or down to the minimal face
+    if (HOURLY_CHIME_ENABLED && (units_changed & HOUR_UNIT) && !quiet_time_is_active()
+     && !sleep_suppressed && governor_allows(GOVERNOR_MINIMAL)) {
+        vibes_enqueue_custom_pattern(HOURLY_CHIME_PATTERNS[tm_get_hours(&civil_time)]);
+    }
+    
+    // Refresh the decimal overlay now if visible, else on the next tap
+    decimal_overlay_stale = true;
+    if (decimal_overlay_timer) {
+        format_decimal_overlay();
+    }
+    
+    // Step features up or down for the next tick
+    governor_update(profiler_now_ms() - tick_start_ms);
+    
+    // Tick hourly from now on if the wearer fell asleep
+    if (SLEEP_SUPPRESSION_ENABLED) {
+        sleep_update();
+    }
+    
+    profile_end(PHASE_TICK);
+}
+
+
+
+//--------------------------GESTURE HANDLERS--------------------------
+
+/**
+ * Called when a gesture is recognized
+ *
+ * @param gesture the gesture that was recognized
+ */
+static void on_gesture(Gesture gesture) {
+    // Only a double flick gets out of the calendar
+    if (CALENDAR_ENABLED && !layer_get_hidden(calendar_layer) && gesture != GESTURE_DOUBLE_FLICK) {
+        return;
+    }
+    
+    // If still ticking hourly, catch up the time about to be shown
+    if (SLEEP_SUPPRESSION_ENABLED && sleep_suppressed) {
+        sleep_catch_up();
+    }
+    
+    switch (gesture) {
+        case GESTURE_FLICK:
+            show_decimal_overlay(DECIMAL_OVERLAY_DURATION_MS);
+            break;
+        case GESTURE_FLICK_AND_HOLD:
+            show_decimal_overlay(DECIMAL_OVERLAY_HOLD_DURATION_MS);
+            break;
+        case GESTURE_DOUBLE_FLICK:
+            toggle_calendar();
+            break;
+    }
+}
+
+/**
+ * Called when the watch is tapped or shaken
+ *
+ * @param axis      the axis the tap was detected on
+ * @param direction the direction of the tap along the axis
+ */
+static void on_tap(AccelAxisType axis, int32_t direction) {
+    // Record tap
+    if (TRACE_CAPTURE_ENABLED) {
+        trace_tap(axis, direction);
+    }
+    
+    // A tap is activity, so check for waking
+    if (SLEEP_SUPPRESSION_ENABLED && sleep_suppressed) {
+        sleep_update();
+    }
+    
+    // A flick soon after the last is a double flick
+    int64_t now = profiler_now_ms();
+    if (CALENDAR_ENABLED && last_tap_ms && now - last_tap_ms <= CALENDAR_DOUBLE_FLICK_MS) {
+        last_tap_ms = 0;
+        on_gesture(GESTURE_DOUBLE_FLICK);
+        return;
+    }
+    last_tap_ms = now;
+    
+    // Return if the calendar is shown, only a double flick gets out of it,
+    // so neither the flick nor a hold needs anything more
+    if (CALENDAR_ENABLED && !layer_get_hidden(calendar_layer)) {
+        return;
+    }
+    
+    // Taps come from the accelerometer's low power tap mode,
+    // so a flick is recognized without any sampling
+    on_gesture(GESTURE_FLICK);
+    
+    // Sample briefly to see if the flick is followed by a hold,
+    // delivered as one batch so the app only wakes once
+    // (not while asleep, where a tap is more likely turning over)
+    if (GESTURE_HOLD_DETECTION_ENABLED && !gesture_sampling && !sleep_suppressed && governor_allows(GOVERNOR_NO_HOLD)) {
+        gesture_sampling = true;
+        accel_data_service_subscribe(GESTURE_HOLD_SAMPLES, on_gesture_samples);
+        accel_service_set_sampling_rate(ACCEL_SAMPLING_10HZ);
+    }
+}
+
+/**
+ * Called with the batch of samples of a hold detection window
+ *
+ * @param data        the accelerometer samples
+ * @param num_samples the number of samples in the batch
+ */
+static void on_gesture_samples(AccelData* data, uint32_t num_samples) {
+    // Stop sampling, returning the accelerometer to tap mode
+    accel_data_service_unsubscribe();
+    gesture_sampling = false;
+    
+    // Find the range of z over the window, ignoring
+    // samples disturbed by the vibration motor
+    int16_t min_z = INT16_MAX, max_z = INT16_MIN;
+    for (uint32_t i = 0; i < num_samples; i++) {
+        if (data[i].did_vibrate) {
+            continue;
+        }
+        if (data[i].z < min_z) {
+            min_z = data[i].z;
+        }
+        if (data[i].z > max_z) {
+            max_z = data[i].z;
+        }
+    }
+    
+    // Held if face up and still the whole window
+    // (max_z stays INT16_MIN if every sample was disturbed)
+    bool held = max_z != INT16_MIN && max_z <= GESTURE_HOLD_MAX_Z && max_z - min_z <= GESTURE_HOLD_MAX_SWING;
+    
+    // Record outcome, as the samples themselves are not traced
+    if (TRACE_CAPTURE_ENABLED) {
+        trace_hold(held);
+    }
+    
+    // Send gesture if held
+    if (held) {
+        on_gesture(GESTURE_FLICK_AND_HOLD);
+    }
+}
+
+
+
+//--------------------------WINDOW HANDLERS--------------------------
+
+/**
+ * Called when the given window is loaded
+ *
+ * @param window the window that was loaded
+ */
+static void on_main_window_load(Window* window) {
+    // Load resources
+    time_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_KEY_PERFECT_DOS_32));
+    date_font = fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FONT_KEY_PERFECT_DOS_24));
+    
+    // Get window information
+    Layer *window_layer = window_get_root_layer(window);
+    GRect window_bounds = layer_get_bounds(window_layer);
+    
+    // Measure fonts
+    measure_font(&time_metrics, time_font);
+    measure_font(&date_metrics, date_font);
+    
+    // Lay out bit cells, relative to the layer of each field
+    cell_count = 0;
+    add_field_cells(FIELD_HOUR, GPoint(0, 0), &time_metrics);
+    add_field_cells(FIELD_MINUTE, GPoint(0, 0), &time_metrics);
+    add_field_cells(FIELD_MONTH, GPoint(0, 0), &date_metrics);
+    add_field_cells(FIELD_DAY, GPoint(0, DATE_HEIGHT), &date_metrics);
+    
+    // Create time and date layers
+    hour_layer = binary_field_layer_create(GPoint(PBL_IF_ROUND_ELSE(LEFT_MARGIN_ROUND, LEFT_MARGIN_SQUARE),
+                                                  PBL_IF_ROUND_ELSE(TIME_TOP_MARGIN_ROUND, TIME_TOP_MARGIN_SQUARE)),
+                                           &hour_field, time_font, &time_metrics);
+    minute_layer = binary_field_layer_create(GPoint(PBL_IF_ROUND_ELSE(LEFT_MARGIN_ROUND, LEFT_MARGIN_SQUARE),
+                                                    PBL_IF_ROUND_ELSE(TIME_TOP_MARGIN_ROUND, TIME_TOP_MARGIN_SQUARE) + TIME_HEIGHT),
+                                             &minute_field, time_font, &time_metrics);
+    // (the day row is the widest row of the date)
+    date_layer = layer_create(GRect(PBL_IF_ROUND_ELSE(LEFT_MARGIN_ROUND, LEFT_MARGIN_SQUARE),
+                                    PBL_IF_ROUND_ELSE(DATE_TOP_MARGIN_ROUND, DATE_TOP_MARGIN_SQUARE),
+                                    DAY_BINARY_LENGTH * date_metrics.cell_width,
+                                    DATE_HEIGHT + date_metrics.row_height));
+    layer_set_update_proc(date_layer, draw_date);
+    
+    // Create date cache the size of the date layer
+    date_cache = cache_bitmap_create(layer_get_bounds(date_layer).size);
+    date_cache_valid = false;
+    
+    // Create progress layer in the gap between the time and the date
+    if (PROGRESS_ROWS_ENABLED) {
+        progress_layer = layer_create(GRect(PBL_IF_ROUND_ELSE(LEFT_MARGIN_ROUND, LEFT_MARGIN_SQUARE),
+                                            PBL_IF_ROUND_ELSE(PROGRESS_TOP_MARGIN_ROUND, PROGRESS_TOP_MARGIN_SQUARE),
+                                            PROGRESS_BINARY_LENGTH * BIT_ROW_CELL_WIDTH,
+                                            PROGRESS_COUNT * BIT_ROW_HEIGHT));
+        layer_set_update_proc(progress_layer, draw_progress);
+    }
+    
+    // Create decimal overlay, hidden until a tap
+    decimal_overlay_layer = text_layer_create(GRect(0, DECIMAL_OVERLAY_TOP_MARGIN,
+                                                    window_bounds.size.w, DECIMAL_OVERLAY_HEIGHT));
+    text_layer_set_background_color(decimal_overlay_layer, GColorBlack);
+    text_layer_set_text_color(decimal_overlay_layer, GColorGreen);
+    text_layer_set_text_alignment(decimal_overlay_layer, GTextAlignmentCenter);
+    text_layer_set_font(decimal_overlay_layer, date_font);
+    layer_set_hidden(text_layer_get_layer(decimal_overlay_layer), true);
+    
+    // Append field layers to window
+    layer_add_child(window_layer, hour_layer);
+    layer_add_child(window_layer, minute_layer);
+    layer_add_child(window_layer, date_layer);
+    if (PROGRESS_ROWS_ENABLED) {
+        layer_add_child(window_layer, progress_layer);
+    }
+    
+    // Create weather layer below the date, hidden until weather is known
+    if (WEATHER_ENABLED) {
+        int weather_width = WEATHER_TEMPERATURE_BINARY_LENGTH * BIT_ROW_CELL_WIDTH;
+        weather_layer = layer_create(GRect(PBL_IF_ROUND_ELSE((ROUND_DISPLAY_SIZE - weather_width) / 2, LEFT_MARGIN_SQUARE),
+                                           PBL_IF_ROUND_ELSE(WEATHER_TOP_MARGIN_ROUND, WEATHER_TOP_MARGIN_SQUARE),
+                                           weather_width, WEATHER_COUNT * BIT_ROW_HEIGHT));
+        layer_set_update_proc(weather_layer, draw_weather);
+        layer_set_hidden(weather_layer, true);
+        layer_add_child(window_layer, weather_layer);
+        weather_restore();
+    }
+    
+    // Append decimal overlay above field layers
+    layer_add_child(window_layer, text_layer_get_layer(decimal_overlay_layer));
+    
+    // Create calendar over the whole face, hidden until a double flick,
+    // with a cache the size of the layer
+    if (CALENDAR_ENABLED) {
+        calendar_layer = layer_create(window_bounds);
+        layer_set_update_proc(calendar_layer, draw_calendar);
+        layer_set_hidden(calendar_layer, true);
+        calendar_cache = cache_bitmap_create(window_bounds.size);
+        calendar_cache_valid = false;
+        layer_add_child(window_layer, calendar_layer);
+    }
+    
+    // Start at the level current conditions call for
+    governor_level = governor_target_level();
+    if (PROGRESS_ROWS_ENABLED) {
+        layer_set_hidden(progress_layer, !governor_allows(GOVERNOR_MINIMAL));
+    }
+    if (WEATHER_ENABLED && weather_known) {
+        layer_set_hidden(weather_layer, !governor_allows(GOVERNOR_MINIMAL));
+    }
+    
+    // Display time on init
+    time_t init_time = time(NULL);
+    civil_time_sync(localtime(&init_time));
+    display_time(&civil_time);
+    
+    // Create everything the tick path needs up front
+    if (BIT_ANIMATION_ENABLED) {
+        prepare_bit_animation();
+    }
+    
+    // Record heap once everything is created
+    heap_baseline = heap_bytes_used();
+}
+
+/**
+ * Called when the given window is unloaded
+ *
+ * @param window the window that was unloaded
+ */
+static void on_main_window_unload(Window* window) {
+    // Stop bit animation and destroy the prepared one
+    if (bit_animation) {
+        animation_unschedule(bit_animation);
+    }
+    if (bit_animation_prepared) {
+        animation_destroy(bit_animation_prepared);
+        bit_animation_prepared = NULL;
+    }
+    
+    // Destroy layers
+    layer_destroy(hour_layer);
+    layer_destroy(minute_layer);
+    layer_destroy(date_layer);
+    gbitmap_destroy(date_cache);
+    if (PROGRESS_ROWS_ENABLED) {
+        layer_destroy(progress_layer);
+    }
+    if (WEATHER_ENABLED) {
+        layer_destroy(weather_layer);
+    }
+    if (CALENDAR_ENABLED) {
+        layer_destroy(calendar_layer);
+        gbitmap_destroy(calendar_cache);
+    }
+    
+    // Cancel decimal overlay timer and destroy overlay
+    if (decimal_overlay_timer) {
+        app_timer_cancel(decimal_overlay_timer);
+        decimal_overlay_timer = NULL;
+    }
+    text_layer_destroy(decimal_overlay_layer);
+    
+    // Unload resources
+    fonts_unload_custom_font(time_font);
+    fonts_unload_custom_font(date_font);
+}
+
+
+
+//--------------------------MAIN PROGRAM--------------------------
+
+/**
+ * Called at the start of the program
+ */
+static void start(void) {
+    // Register with the tick timer service
+    tick_timer_service_subscribe(MINUTE_UNIT, on_tick);
+    
+    // Register with the tap service
+    accel_tap_service_subscribe(on_tap);
+    
+#if defined(PBL_HEALTH)
+    // Register with the health service to wake up with the wearer
+    if (SLEEP_SUPPRESSION_ENABLED) {
+        health_service_events_subscribe(on_health_event, NULL);
+    }
+#endif
+    
+    // Open telemetry session, resuming the one left by the last run
+    if (TELEMETRY_ENABLED) {
+        telemetry_session = data_logging_create(TELEMETRY_TAG, DATA_LOGGING_BYTE_ARRAY,
+                                                sizeof(TelemetryRecord), true);
+    }
+    
+    // Register with the app message service
+    app_message_register_inbox_received(on_message_received);
+    app_message_open(APP_MESSAGE_INBOX_SIZE, APP_MESSAGE_OUTBOX_SIZE);
+    
+    // Resume countdown before the first display
+    if (COUNTDOWN_ENABLED) {
+        wakeup_service_subscribe(on_wakeup);
+        
+        // Record the wakeup that launched the face, if any
+        if (TRACE_CAPTURE_ENABLED && launch_reason() == APP_LAUNCH_WAKEUP) {
+            WakeupId launch_id;
+            int32_t launch_cookie;
+            wakeup_get_launch_event(&launch_id, &launch_cookie);
+            trace_wakeup(launch_cookie);
+        }
+        
+        countdown_restore();
+    }
+    
+    // Create main window
+    main_window = window_create();
+    
+    // Set window handlers
+    window_set_window_handlers(main_window, (WindowHandlers) {
+        .load = on_main_window_load,
+        .unload = on_main_window_unload
+    });
+    
+    // Set window color
+    window_set_background_color(main_window, GColorBlack);
+    
+    // Display main window
+    window_stack_push(main_window, true);
+}
+
+/**
+ * Called at the end of the program
+ */
+static void end(void) {
+    // Dump what is left of the trace
+    if (TRACE_CAPTURE_ENABLED) {
+        trace_flush();
+    }
+    
+    // Close telemetry session
+    if (TELEMETRY_ENABLED) {
+        data_logging_finish(telemetry_session);
+    }
+    
+    // Destroy main window
     window_destroy(main_window);
     
-    // Unsubscribe from the tick timer service
+    // Unsubscribe from the tick timer, accelerometer, app message and health services
     tick_timer_service_unsubscribe();
+    accel_tap_service_unsubscribe();
+    app_message_deregister_callbacks();
+    if (gesture_sampling) {
+        accel_data_service_unsubscribe();
+    }
+#if defined(PBL_HEALTH)
+    if (SLEEP_SUPPRESSION_ENABLED) {
+        health_service_events_unsubscribe();
+    }
+#endif
 }
 
 /**
@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""
+Mock receiver for the hourly telemetry records the watchface sends through
+data logging (tag 0x42540001). Reads raw records from a file, or hex encoded
+records one per line from stdin, and prints one decoded hour per line.
+
+Keep RECORD in sync with TelemetryRecord in src/main.c.
+"""
+import struct
+import sys
+import time
+
+BUCKET_LIMITS_MS = [1, 2, 5, 10, 20, 50, 100, 200, 500, 1000]
+BUCKET_COUNT = len(BUCKET_LIMITS_MS) + 1
+RECORD = struct.Struct('<I6H%dH%dH' % (BUCKET_COUNT, BUCKET_COUNT))
+
+
+def decode(data):
+    """Yields one dict per whole record in the given bytes"""
+    for offset in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        fields = RECORD.unpack_from(data, offset)
+        yield {
+            'hour_start': fields[0],
+            'ticks': fields[1],
+            'draws': fields[2],
+            'bit_flips': fields[3],
+            'worst_latency_ms': fields[4],
+            'heap_peak_bytes': fields[5],
+            'saved_ticks': fields[6],
+            'update_latency': fields[7:7 + BUCKET_COUNT],
+            'tick_jitter': fields[7 + BUCKET_COUNT:],
+        }
+
+
+def format_record(record):
+    hour = time.strftime('%Y-%m-%d %H:00', time.gmtime(record['hour_start']))
+    return ('%s ticks=%d draws=%d flips=%d worst=%dms heap=%dB '
+            'saved=%d latency=%s jitter=%s') % (
+        hour, record['ticks'], record['draws'], record['bit_flips'],
+        record['worst_latency_ms'], record['heap_peak_bytes'],
+        record['saved_ticks'],
+        ','.join(map(str, record['update_latency'])),
+        ','.join(map(str, record['tick_jitter'])))
+
+
+def main(argv):
+    if len(argv) > 1:
+        with open(argv[1], 'rb') as f:
+            data = f.read()
+    else:
+        data = b''.join(bytes.fromhex(line.strip()) for line in sys.stdin if line.strip())
+    for record in decode(data):
+        print(format_record(record))
+
+
+if __name__ == '__main__':
+    main(sys.argv)